@@ -0,0 +1,143 @@
+/*
+
+小さなベンチマークの道具。Google Benchmarkを入れるほどでもないので自前で。
+
+run()は、1回の計測が目安の時間(min_time)を超えるまで回数を倍々にしてから、同じ回数でrepetitions回測って一番速いものを取る。
+ns/opと、1回あたりのoperator newの回数を記録する。newを数えるには、mainのある翻訳単位で
+HARUROBO2022_BENCH_COUNT_ALLOCATIONSを一度だけ書いておくこと(グローバルなoperator newを置き換える)。
+
+結果はwrite_json()で書き出す。差分を見るときは前のファイルと並べて比べる。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+namespace Bench
+{
+    namespace
+    {
+        inline std::atomic<std::uint64_t> allocation_count{0};
+
+        struct Result final
+        {
+            std::string name;
+            std::size_t size;  // 1回でいくつ処理するか(1回あたりのns/opはこれで割ってある)
+            std::uint64_t iterations;
+            double ns_per_op;
+            double allocations_per_op;
+        };
+
+        struct Option final
+        {
+            double min_time{0.05};  // [s]
+            int repetitions{5};
+        };
+
+        // 結果を捨てられないようにする。
+        template<class T>
+        inline void do_not_optimize(T& value) noexcept
+        {
+            asm volatile("" : "+m"(value) : : "memory");
+        }
+
+        inline void clobber_memory() noexcept
+        {
+            asm volatile("" : : : "memory");
+        }
+
+        class Runner final
+        {
+            Option option;
+            std::vector<Result> results{};
+
+        public:
+            Runner(const Option& option = {}) noexcept:
+                option{option}
+            {}
+
+            // fは1回分の処理。sizeはその中でいくつ処理するか。
+            template<class F>
+            void run(const char *const name, const std::size_t size, F&& f) noexcept
+            {
+                using Clock = std::chrono::steady_clock;
+
+                const auto measure = [&f](const std::uint64_t iterations) noexcept
+                {
+                    const auto start = Clock::now();
+                    for(std::uint64_t i = 0; i < iterations; ++i)
+                    {
+                        f();
+                        clobber_memory();
+                    }
+                    return std::chrono::duration<double>(Clock::now() - start).count();
+                };
+
+                std::uint64_t iterations = 1;
+                while(measure(iterations) < option.min_time && iterations < (std::uint64_t{1} << 40)) iterations *= 2;
+
+                double best = 1e300;
+                std::uint64_t allocations = 0;
+                for(int i = 0; i < option.repetitions; ++i)
+                {
+                    const std::uint64_t before = allocation_count.load(std::memory_order_relaxed);
+                    best = std::min(best, measure(iterations));
+                    allocations = allocation_count.load(std::memory_order_relaxed) - before;
+                }
+
+                const double ops = static_cast<double>(iterations) * size;
+                results.push_back({name, size, iterations, best * 1e9 / ops, allocations / ops});
+
+                std::printf("%-40s %10.3f ns/op %8.3f allocs/op\n", name, results.back().ns_per_op, results.back().allocations_per_op);
+            }
+
+            const std::vector<Result>& get_results() const noexcept
+            {
+                return results;
+            }
+
+            bool write_json(const char *const path) const noexcept
+            {
+                std::FILE *const fp = std::fopen(path, "w");
+                if(!fp) return false;
+
+                std::fprintf(fp, "{\n  \"compiler\": \"%s\",\n  \"benchmarks\": [\n", __VERSION__);
+                for(std::size_t i = 0; i < results.size(); ++i)
+                {
+                    const auto& result = results[i];
+                    std::fprintf
+                    (
+                        fp,
+                        "    {\"name\": \"%s\", \"size\": %zu, \"iterations\": %llu, \"ns_per_op\": %.4f, \"allocations_per_op\": %.4f}%s\n",
+                        result.name.c_str(), result.size, static_cast<unsigned long long>(result.iterations),
+                        result.ns_per_op, result.allocations_per_op, (i + 1 < results.size()) ? "," : ""
+                    );
+                }
+                std::fprintf(fp, "  ]\n}\n");
+
+                return std::fclose(fp) == 0;
+            }
+        };
+    }
+}
+
+#define HARUROBO2022_BENCH_COUNT_ALLOCATIONS \
+    void * operator new(const std::size_t size) \
+    { \
+        Bench::allocation_count.fetch_add(1, std::memory_order_relaxed); \
+        if(void *const p = std::malloc(size ? size : 1)) return p; \
+        throw std::bad_alloc{}; \
+    } \
+    void operator delete(void *const p) noexcept { std::free(p); } \
+    void operator delete(void *const p, std::size_t) noexcept { std::free(p); }
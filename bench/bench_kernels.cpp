@@ -0,0 +1,222 @@
+/*
+
+StewLibと足回りの計算のベンチマーク。ROSにもcatkinにも依存しない(メッセージの型はsim/includeのものを使う)。
+ビルドはbench/CMakeLists.txt。
+
+使い方:
+    bench_kernels [結果のjson(既定はbench_kernels.json)]
+
+サイズは実機に合わせてある。Vec2Dは1周期に触る程度の数、足回りは4輪。
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <array>
+#include <vector>
+
+#include <harurobo2022/Twist.h>
+#include <harurobo2022/Odometry.h>
+
+#include "harurobo2022/lib/vec2d.hpp"
+#include "harurobo2022/lib/can_codec.hpp"
+#include "harurobo2022/lib/omni_kinematics.hpp"
+#include "harurobo2022/lib/rate_limiter.hpp"
+#include "harurobo2022/lib/trapezoidal_path.hpp"
+#include "harurobo2022/config.hpp"
+#include "harurobo2022/message_convertor/harurobo2022/Twist.hpp"
+#include "harurobo2022/message_convertor/harurobo2022/Odometry.hpp"
+
+#include "bench.hpp"
+
+HARUROBO2022_BENCH_COUNT_ALLOCATIONS
+
+using namespace StewLib;
+using namespace Harurobo2022;
+
+namespace
+{
+    constexpr std::size_t vec_size = 256;
+
+    std::vector<Vec2D<float>> make_points() noexcept
+    {
+        std::vector<Vec2D<float>> points(vec_size);
+        for(std::size_t i = 0; i < vec_size; ++i)
+        {
+            points[i] = Vec2D<float>(std::cos(i * 0.1f) * 1000, std::sin(i * 0.1f) * 1000);
+        }
+        return points;
+    }
+
+    void vec2d(Bench::Runner& runner) noexcept
+    {
+        auto points = make_points();
+        const auto offset = Vec2D<float>(1.5f, -2.5f);
+
+        runner.run("vec2d/add", vec_size, [&]() noexcept
+        {
+            for(auto& point : points) point = point + offset;
+            Bench::do_not_optimize(points[0]);
+        });
+
+        runner.run("vec2d/norm", vec_size, [&]() noexcept
+        {
+            float sum = 0;
+            for(const auto& point : points) sum += +point;
+            Bench::do_not_optimize(sum);
+        });
+
+        runner.run("vec2d/rot", vec_size, [&]() noexcept
+        {
+            for(auto& point : points) point = rot(point, 0.001);
+            Bench::do_not_optimize(points[0]);
+        });
+    }
+
+    void can_data(Bench::Runner& runner) noexcept
+    {
+        const std::array<float, 2> payload{1.0f, 2.0f};
+        runner.run("can_frames/8byte", 1, [&]() noexcept
+        {
+            CanFrames<std::array<float, 2>> frames{payload};
+            Bench::do_not_optimize(frames);
+        });
+
+        const std::array<float, 3> payload12{1.0f, 2.0f, 3.0f};
+        runner.run("can_frames/12byte", 1, [&]() noexcept
+        {
+            CanFrames<std::array<float, 3>> frames{payload12};
+            Bench::do_not_optimize(frames);
+        });
+
+        float value_f{1.0f};
+        runner.run("big_endian/float", 1, [&]() noexcept
+        {
+            BigEndian<float> buffer_f{value_f};
+            Bench::do_not_optimize(buffer_f);
+        });
+
+        double value_d{1.0};
+        runner.run("big_endian/double", 1, [&]() noexcept
+        {
+            BigEndian<double> buffer_d{value_d};
+            Bench::do_not_optimize(buffer_d);
+        });
+    }
+
+    void message_convertor(Bench::Runner& runner) noexcept
+    {
+        using Twist = MessageConvertor<harurobo2022::Twist>;
+        using Odometry = MessageConvertor<harurobo2022::Odometry>;
+
+        Twist::RawData twist_raw{100.0f, -50.0f, 0.5f};
+        runner.run("convertor/twist_raw_to_can", 1, [&]() noexcept
+        {
+            Twist::CanData can_data = Twist{twist_raw};
+            Bench::do_not_optimize(can_data);
+        });
+
+        harurobo2022::Twist twist_msg{};
+        runner.run("convertor/twist_msg_to_raw", 1, [&]() noexcept
+        {
+            Twist::RawData raw_data = Twist{twist_msg};
+            Bench::do_not_optimize(raw_data);
+        });
+
+        runner.run("convertor/twist_raw_to_msg", 1, [&]() noexcept
+        {
+            harurobo2022::Twist msg = Twist{twist_raw};
+            Bench::do_not_optimize(msg);
+        });
+
+        Odometry::RawData odometry_raw{1000.0f, 2000.0f, 0.1f};
+        runner.run("convertor/odometry_raw_to_can", 1, [&]() noexcept
+        {
+            Odometry::CanData can_data = Odometry{odometry_raw};
+            Bench::do_not_optimize(can_data);
+        });
+    }
+
+    // under_carriage_4wheel_nodeのcalc_wheels_velaと同じもの。
+    void under_carriage(Bench::Runner& runner) noexcept
+    {
+        using namespace Config::Wheel;
+
+        static constexpr OmniKinematics<4> kinematics{Pos::all, Direction::all, Config::wheel_radius};
+        RateLimiter<4> rate_limiter
+        {
+            {Config::Limitation::wheel_vela, Config::Limitation::wheel_acca, Config::Limitation::wheel_jerk},
+            1.0 / Config::ExecutionInterval::under_carriage_freq
+        };
+
+        double wheels_vela[4]{};
+        std::uint64_t tick = 0;
+
+        runner.run("under_carriage/kinematics", 1, [&]() noexcept
+        {
+            const Vec2D<double> body_vell(std::sin(tick * 1e-3) * 1000, 500);
+            ++tick;
+            double max_abs_vela = kinematics.inverse(body_vell, 0.5, wheels_vela);
+            Bench::do_not_optimize(max_abs_vela);
+        });
+
+        runner.run("under_carriage/calc_wheels_vela", 1, [&]() noexcept
+        {
+            const Vec2D<double> body_vell(std::sin(tick * 1e-3) * 1000, 500);
+            ++tick;
+            const double max_abs_vela = kinematics.inverse(body_vell, 0.5, wheels_vela);
+            rate_limiter(wheels_vela, max_abs_vela);
+            Bench::do_not_optimize(wheels_vela);
+        });
+    }
+
+    void trajectory(Bench::Runner& runner) noexcept
+    {
+        std::vector<TrapezoidalPath::Waypoint> waypoints;
+        for(int i = 1; i <= 20; ++i) waypoints.push_back({{i * 500.0, (i % 2) * 500.0}, 50});
+
+        TrapezoidalPath path{};
+        runner.run("trajectory/plan_20", 1, [&]() noexcept
+        {
+            path.plan({0, 0}, waypoints, Config::Limitation::body_vell, Config::Limitation::body_accl, Config::Pid::position_k_p);
+            Bench::do_not_optimize(path);
+        });
+
+        double t = 0;
+        const double step = 1.0 / Config::ExecutionInterval::auto_commander_freq;
+        runner.run("trajectory/sample", 1, [&]() noexcept
+        {
+            t += step;
+            if(t > path.get_total_time())
+            {
+                t = 0;
+                path.rewind();
+            }
+            auto sample = path.sample(t);
+            Bench::do_not_optimize(sample);
+        });
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    const char *const path = (argc > 1) ? argv[1] : "bench_kernels.json";
+
+    Bench::Runner runner{};
+
+    vec2d(runner);
+    can_data(runner);
+    message_convertor(runner);
+    under_carriage(runner);
+    trajectory(runner);
+
+    if(!runner.write_json(path))
+    {
+        std::fprintf(stderr, "failed to write %s.\n", path);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,343 @@
+/*
+
+can_tx/can_rxのフレームをそのまま記録するためのファイル。rosbagより軽く、取りこぼさない。
+
+先頭32バイトがヘッダ(magic "HR22CLOG", 版, 1件の大きさ, 件数, 捨てた数)で、その後ろにCanLogRecordがそのまま並ぶ。
+エンディアンと詰め物は書いた機械のもの(csv_parser.hppのバイナリと同じ前提)。
+
+書く側(CanLogWriter)は最初にcapacity件分の大きさでファイルを作ってmmap(MAP_SHARED)し、1件ごとにヘッダの件数を書き換える。
+なのでプロセスが落ちてもそこまでの記録は残る。溢れた分は捨てて数える。閉じるときに余った分を切り詰める。
+読む側(CanLogReader)はmmapしてそのまま指す。
+
+時刻はCLOCK_MONOTONIC(StewLib::monotonic_ns)。フレームのheader.stampはMessageConvertorの中にそのまま残る。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <can_plugins/Frame.h>
+
+#include "lib/shm_ring.hpp"
+#include "message_convertor/can_plugins/Frame.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        enum class CanLogDirection : std::uint8_t
+        {
+            tx,
+            rx
+        };
+
+        struct CanLogRecord final
+        {
+            std::uint64_t stamp_ns{};
+            CanLogDirection direction{};
+            MessageConvertor<can_plugins::Frame> frame{};
+        };
+
+        static_assert(std::is_trivially_copyable_v<CanLogRecord>, "CanLogRecord must be trivially copyable.");
+
+        namespace CanLogImplement
+        {
+            inline constexpr char magic[8] = {'H', 'R', '2', '2', 'C', 'L', 'O', 'G'};
+            inline constexpr std::uint32_t version = 1;
+
+            struct Header final
+            {
+                char magic[8];
+                std::uint32_t version;
+                std::uint32_t record_size;
+                std::uint64_t count;
+                std::uint64_t dropped;
+            };
+            static_assert(sizeof(Header) == 32, "Header must be 32 bytes.");
+        }
+
+        class CanLogWriter final
+        {
+            int fd{-1};
+            void * mapped{nullptr};
+            std::size_t capacity{0};
+
+            CanLogImplement::Header * header() const noexcept
+            {
+                return static_cast<CanLogImplement::Header *>(mapped);
+            }
+
+            CanLogRecord * records() const noexcept
+            {
+                return reinterpret_cast<CanLogRecord *>(static_cast<char *>(mapped) + sizeof(CanLogImplement::Header));
+            }
+
+        public:
+            CanLogWriter() = default;
+
+            CanLogWriter(CanLogWriter&& other) noexcept:
+                fd{std::exchange(other.fd, -1)},
+                mapped{std::exchange(other.mapped, nullptr)},
+                capacity{std::exchange(other.capacity, 0)}
+            {}
+
+            CanLogWriter& operator=(CanLogWriter&& other) noexcept
+            {
+                if(this != &other)
+                {
+                    close();
+                    fd = std::exchange(other.fd, -1);
+                    mapped = std::exchange(other.mapped, nullptr);
+                    capacity = std::exchange(other.capacity, 0);
+                }
+                return *this;
+            }
+
+            ~CanLogWriter() noexcept
+            {
+                close();
+            }
+
+            // pathを作り直してcapacity件分の場所を取る。
+            static std::optional<CanLogWriter> create(const char *const path, const std::size_t capacity) noexcept
+            {
+                using CanLogImplement::Header;
+
+                const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if(fd < 0) return std::nullopt;
+
+                const std::size_t file_size = sizeof(Header) + capacity * sizeof(CanLogRecord);
+                if(::ftruncate(fd, file_size) != 0)
+                {
+                    ::close(fd);
+                    return std::nullopt;
+                }
+
+                void *const p = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if(p == MAP_FAILED)
+                {
+                    ::close(fd);
+                    return std::nullopt;
+                }
+
+                CanLogWriter ret{};
+                ret.fd = fd;
+                ret.mapped = p;
+                ret.capacity = capacity;
+
+                Header& h = *ret.header();
+                std::memcpy(h.magic, CanLogImplement::magic, sizeof(h.magic));
+                h.version = CanLogImplement::version;
+                h.record_size = sizeof(CanLogRecord);
+                h.count = 0;
+                h.dropped = 0;
+
+                return ret;
+            }
+
+            bool is_open() const noexcept
+            {
+                return mapped;
+            }
+
+            std::uint64_t size() const noexcept
+            {
+                return mapped ? header()->count : 0;
+            }
+
+            std::uint64_t dropped() const noexcept
+            {
+                return mapped ? header()->dropped : 0;
+            }
+
+            // 周期の途中で確保やシステムコールが走らないよう、溢れたら捨てる。
+            void append(const CanLogRecord& record) noexcept
+            {
+                if(!mapped) return;
+
+                CanLogImplement::Header& h = *header();
+                if(h.count == capacity)
+                {
+                    ++h.dropped;
+                    return;
+                }
+
+                std::memcpy(records() + h.count, &record, sizeof(CanLogRecord));
+                ++h.count;
+            }
+
+            // 使わなかった分を切り詰めて閉じる。
+            void close() noexcept
+            {
+                if(!mapped) return;
+
+                const std::size_t used_size = sizeof(CanLogImplement::Header) + header()->count * sizeof(CanLogRecord);
+                ::munmap(mapped, sizeof(CanLogImplement::Header) + capacity * sizeof(CanLogRecord));
+                mapped = nullptr;
+
+                [[maybe_unused]] const int result = ::ftruncate(fd, used_size);
+                ::close(fd);
+                fd = -1;
+                capacity = 0;
+            }
+        };
+
+        class CanLogReader final
+        {
+            void * mapped{nullptr};
+            std::size_t mapped_size{0};
+            const CanLogRecord * records{nullptr};
+            std::size_t count{0};
+            std::uint64_t dropped_count{0};
+
+        public:
+            CanLogReader() = default;
+
+            CanLogReader(CanLogReader&& other) noexcept:
+                mapped{std::exchange(other.mapped, nullptr)},
+                mapped_size{std::exchange(other.mapped_size, 0)},
+                records{std::exchange(other.records, nullptr)},
+                count{std::exchange(other.count, 0)},
+                dropped_count{std::exchange(other.dropped_count, 0)}
+            {}
+
+            CanLogReader& operator=(CanLogReader&& other) noexcept
+            {
+                if(this != &other)
+                {
+                    unmap();
+                    mapped = std::exchange(other.mapped, nullptr);
+                    mapped_size = std::exchange(other.mapped_size, 0);
+                    records = std::exchange(other.records, nullptr);
+                    count = std::exchange(other.count, 0);
+                    dropped_count = std::exchange(other.dropped_count, 0);
+                }
+                return *this;
+            }
+
+            ~CanLogReader() noexcept
+            {
+                unmap();
+            }
+
+            // 読めなければwhatに理由を入れてnulloptを返す。
+            static std::optional<CanLogReader> open(const char *const path, const char *& what) noexcept
+            {
+                using CanLogImplement::Header;
+
+                const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+                if(fd < 0)
+                {
+                    what = "cannot open file.";
+                    return std::nullopt;
+                }
+
+                struct stat st;
+                if(::fstat(fd, &st) != 0)
+                {
+                    ::close(fd);
+                    what = "cannot stat file.";
+                    return std::nullopt;
+                }
+                const std::size_t file_size = st.st_size;
+
+                if(file_size < sizeof(Header))
+                {
+                    ::close(fd);
+                    what = "header is truncated.";
+                    return std::nullopt;
+                }
+
+                void *const p = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+                if(p == MAP_FAILED)
+                {
+                    what = "mmap failed.";
+                    return std::nullopt;
+                }
+
+                CanLogReader ret{};
+                ret.mapped = p;
+                ret.mapped_size = file_size;
+
+                Header header;
+                std::memcpy(&header, p, sizeof(header));
+
+                if(std::memcmp(header.magic, CanLogImplement::magic, sizeof(header.magic)) != 0)
+                {
+                    what = "not a can log.";
+                    return std::nullopt;
+                }
+                if(header.version != CanLogImplement::version)
+                {
+                    what = "unsupported version.";
+                    return std::nullopt;
+                }
+                if(header.record_size != sizeof(CanLogRecord))
+                {
+                    what = "record size mismatch.";
+                    return std::nullopt;
+                }
+
+                // 書いている途中で落ちたものは件数までしか信じない。件数よりファイルが短ければ入っている分だけ。
+                const std::size_t available = (file_size - sizeof(Header)) / sizeof(CanLogRecord);
+                ret.count = std::min<std::uint64_t>(header.count, available);
+                ret.dropped_count = header.dropped;
+                ret.records = reinterpret_cast<const CanLogRecord *>(static_cast<const char *>(p) + sizeof(Header));
+
+                return ret;
+            }
+
+            const CanLogRecord * begin() const noexcept
+            {
+                return records;
+            }
+
+            const CanLogRecord * end() const noexcept
+            {
+                return records + count;
+            }
+
+            std::size_t size() const noexcept
+            {
+                return count;
+            }
+
+            const CanLogRecord& operator[](const std::size_t i) const noexcept
+            {
+                return records[i];
+            }
+
+            // 記録中に溢れて捨てた数
+            std::uint64_t dropped() const noexcept
+            {
+                return dropped_count;
+            }
+
+        private:
+            void unmap() noexcept
+            {
+                if(mapped)
+                {
+                    ::munmap(mapped, mapped_size);
+                    mapped = nullptr;
+                    mapped_size = 0;
+                    records = nullptr;
+                    count = 0;
+                }
+            }
+        };
+    }
+}
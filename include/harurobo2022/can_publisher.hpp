@@ -1,29 +1,217 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 #include <can_plugins/Frame.h>
 
-#include "lib/serialize.hpp"
+#include "lib/can_codec.hpp"
 #include "message_convertor/all.hpp"
 #include "topic.hpp"
 #include "publisher.hpp"
 #include "stringlike_types.hpp"
 #include "static_init_deinit.hpp"
+#include "can_shm_ring.hpp"
+#include "config.hpp"
+#include "trace.hpp"
+#include "debug_mirror.hpp"
+#include "can_tx_scheduler.hpp"
 
 namespace Harurobo2022
 {
     namespace
     {
+        // このノードが送ったフレームの数え上げ。バスの使用率を見る用。
+        struct CanTxStats final
+        {
+            std::uint64_t frames{0};
+            // スタッフィングを最悪で見積もったビット数
+            std::uint64_t bits{0};
+            // 変わっていないので送らなかったフレーム(ShirasuPublisherのTargetFilter)
+            std::uint64_t suppressed_frames{0};
+            // 予算を超えて、前と同じ中身だったので捨てたフレーム(can_tx_scheduler.hpp)
+            std::uint64_t throttled_frames{0};
+        };
+
         namespace CanPublisherImplement
         {
             struct CanPublisherBase
             {
                 using can_tx = Topic<StringlikeTypes::can_tx, can_plugins::Frame>;
+                using Frame = MessageConvertor<can_plugins::Frame>;
+
                 inline static Publisher<can_tx> * canpub_p{nullptr};
+                inline static CanShmRing * shm_ring_p{nullptr};
+                inline static std::uint64_t shm_ring_last_open_ns{0};
+
+                // CanTxBatchが生きている間はここに溜めて、最後に一度に送る。
+                constexpr static std::size_t batch_capacity = 64;
+                inline static Frame batch[batch_capacity]{};
+                inline static std::size_t batch_size{0};
+                inline static std::uint32_t batch_depth{0};
+
+                inline static CanTxStats stats{};
+
+            protected:
+                static void transmit(const Frame& frame) noexcept
+                {
+                    if(!CanTxScheduler::admit(frame))
+                    {
+                        ++stats.throttled_frames;
+                        return;
+                    }
+
+                    ++stats.frames;
+                    stats.bits += can_frame_bits(frame.dlc, frame.is_extended);
+
+                    if constexpr(Config::Tracing::enable)
+                    {
+                        if(const std::uint32_t trace_id = Trace::current_id())
+                        {
+                            const ros::Time now = ros::Time::now();
+                            Trace::record(trace_id, Trace::Stage::can_enqueue, now);
+
+                            Frame traced_frame = frame;
+                            traced_frame.seq = trace_id;
+                            traced_frame.stamp_ns = now.toNSec();
+                            enqueue(traced_frame);
+                            return;
+                        }
+                    }
+
+                    enqueue(frame);
+                }
+
+            private:
+                static void enqueue(const Frame& frame) noexcept
+                {
+                    if(!batch_depth)
+                    {
+                        send(frame);
+                        return;
+                    }
+
+                    if(batch_size == batch_capacity)
+                    {
+                        flush();
+                    }
+
+                    batch[batch_size++] = frame;
+                }
+
+            protected:
+                // 優先度の順に並べてから(can_tx_scheduler.hpp)、共有メモリのリングに溜まったぶん全部をまとめて積む。
+                // 積めなければ(リングがない、満杯)全部をcan_txに1フレームずつ。フレームごとに道を変えると、
+                // 分けて送るデータのフレームの順番が入れ替わることがあるので、道はまとめて一つ。
+                // slcan_bridgeはcan_txを1フレームずつしか読まないので、ROSで送るときのメッセージの数は減らない。
+                // まとめて得をするのは、並べ替えと途中で分かれないことと、リングに一度に積めることだけ。
+                static void flush() noexcept
+                {
+                    if(!batch_size) return;
+
+                    CanTxScheduler::order(batch, batch_size);
+
+                    if(!try_push_shm_ring(batch, batch_size))
+                    {
+                        for(std::size_t i = 0; i < batch_size; ++i)
+                        {
+                            canpub_p->publish(batch[i]);
+                        }
+                    }
+
+                    batch_size = 0;
+                }
+
+            private:
+                // 共有メモリのリングに積めればそちらで、だめならROSで送る。
+                static void send(const Frame& frame) noexcept
+                {
+                    if(!try_push_shm_ring(&frame, 1))
+                    {
+                        canpub_p->publish(frame);
+                    }
+                }
+
+                // 全部積めたときだけtrue。一部だけ積むことはない。
+                static bool try_push_shm_ring(const Frame *const frames, const std::size_t size) noexcept
+                {
+                    if constexpr(!Config::CanTx::use_shm_ring) return false;
+
+                    const std::uint64_t now_ns = StewLib::monotonic_ns();
+                    if(!is_shm_ring_ready(now_ns)) return false;
+
+                    return shm_ring_p->try_push_all(size, [frames, now_ns](const std::size_t i) noexcept { return CanShmRecord{now_ns, frames[i]}; });
+                }
+
+                // 読む側が後から立ち上がったり作り直したりしても拾えるよう、死んでいたら1秒おきに開き直す。
+                // 死んだと見てROSに切り替えたとき、リングに残ったものはこちらでは消さない。読む側が戻ったときに
+                // 時刻を見て捨てる(can_shm_bridge_node.cpp)。
+                static bool is_shm_ring_ready(const std::uint64_t now_ns) noexcept
+                {
+                    if constexpr(!Config::CanTx::use_shm_ring) return false;
+
+                    constexpr std::uint64_t timeout_ns = Config::CanTx::shm_consumer_timeout * 1'000'000'000;
+
+                    if(shm_ring_p && shm_ring_p->is_consumer_alive(now_ns, timeout_ns)) return true;
+
+                    if(now_ns - shm_ring_last_open_ns < 1'000'000'000) return false;
+                    shm_ring_last_open_ns = now_ns;
+
+                    CanShmRing shm_ring = CanShmRing::open(Config::CanTx::shm_ring_name);
+                    if(!shm_ring.is_open()) return false;
+
+                    if(shm_ring_p) *shm_ring_p = std::move(shm_ring);
+                    else shm_ring_p = new CanShmRing{std::move(shm_ring)};
+
+                    return shm_ring_p->is_consumer_alive(now_ns, timeout_ns);
+                }
             };
         }
 
+        inline const CanTxStats& get_can_tx_stats() noexcept
+        {
+            return CanPublisherImplement::CanPublisherBase::stats;
+        }
+
+        inline void count_suppressed_frames(const std::size_t count) noexcept
+        {
+            CanPublisherImplement::CanPublisherBase::stats.suppressed_frames += count;
+        }
+
+        // 制御周期の頭で作っておくと、その周期中のcan_publishが全部まとめて送られる。入れ子にしてもよい。
+        class CanTxBatch final : protected CanPublisherImplement::CanPublisherBase
+        {
+        public:
+            CanTxBatch() noexcept
+            {
+                ++batch_depth;
+            }
+
+            // これからreserve個のフレームを続けて積む。今の溜まりに入りきらなければ先に送っておき、途中で分かれないようにする。
+            explicit CanTxBatch(const std::size_t reserve) noexcept:
+                CanTxBatch()
+            {
+                if(batch_size + reserve > batch_capacity)
+                {
+                    flush();
+                }
+            }
+
+            ~CanTxBatch() noexcept
+            {
+                if(!--batch_depth)
+                {
+                    flush();
+                }
+            }
+
+            CanTxBatch(const CanTxBatch&) = delete;
+            CanTxBatch& operator=(const CanTxBatch&) = delete;
+            CanTxBatch(CanTxBatch&&) = delete;
+            CanTxBatch& operator=(CanTxBatch&&) = delete;
+        };
+
         template<class CanTxTopic_>
         class CanPublisher final : protected CanPublisherImplement::CanPublisherBase
         {
@@ -36,36 +224,53 @@ namespace Harurobo2022
             using Message = CanTxTopic::Message;
         
         private:
-            Publisher<CanTxTopic, PublisherOption{.disable_can_tx_topic_warn{true}}> pub;
+            // デバッグ用のトピック。流すかどうかはdebug_mirror.hpp。
+            DebugMirror<CanTxTopic> mirror;
 
         public:
+            // can_queue_sizeはcan_txのキューの大きさ(全部のCanPublisherで一番大きいもの)。nomal_queue_sizeはデバッグ用のトピックのもので、0ならConfig::DebugMirror::queue_size。
             CanPublisher(const std::uint32_t can_queue_size, const std::uint32_t nomal_queue_size = 0) noexcept:
-                pub{(nomal_queue_size)? nomal_queue_size : can_queue_size}
+                mirror{(nomal_queue_size)? nomal_queue_size : Config::DebugMirror::queue_size}
             {
                 canpub_p->change_buff_size_if_larger(can_queue_size);
             }
 
+        private:
+            using CanData = MessageConvertor::CanData;
+            using CanFrames = StewLib::CanFrames<CanData>;
+
+        public:
+            // 1回のcan_enqueueで積むフレームの数
+            constexpr static std::size_t frame_count = CanFrames::Layout::frame_count;
+
             void can_publish(const MessageConvertor& conv) noexcept
             {
-                StewLib::Serialize<8, typename MessageConvertor::CanData> serialize{conv};
+                can_enqueue(conv);
+                mirror.publish(conv);
+            }
 
-                for(std::size_t i = 0; i < serialize.chunks_size - 1; ++i)
+            // CANに送るだけで、デバッグ用のトピックには流さない。
+            void can_enqueue(const MessageConvertor& conv) noexcept
+            {
+                const CanFrames frames{static_cast<CanData>(conv)};
+
+                CanTxBatch batch{frame_count};
+
+                for(std::size_t i = 0; i < frame_count; ++i)
                 {
-                    canpub_p->publish({CanTxTopic::id, 8, serialize.chunks[i]});
+                    transmit({CanTxTopic::id, CanFrames::Layout::dlc(i), frames.chunks[i]});
                 }
-
-                canpub_p->publish({CanTxTopic::id, serialize.last_size, serialize.chunks[serialize.chunks_size - 1]});
-                pub.publish(conv);
             }
 
+            // デバッグ用のトピックにだけ流す。
             void publish(const MessageConvertor& conv) noexcept
             {
-                pub.publish(conv);
+                mirror.publish(conv);
             }
 
             ros::Publisher get_pub() const noexcept
             {
-                return pub.get_pub();
+                return mirror.get_pub();
             }
 
             ros::Publisher get_canpub() const noexcept
@@ -75,12 +280,12 @@ namespace Harurobo2022
 
             void deactivate() noexcept
             {
-                pub.deactivate();
+                mirror.deactivate();
             }
 
             void activate() noexcept
             {
-                pub.activate();
+                mirror.activate();
             }
         };
 
@@ -94,6 +299,7 @@ namespace Harurobo2022
 
             inline const auto deinit = []() noexcept
             {
+                delete CanPublisherImplement::CanPublisherBase::shm_ring_p;
                 delete CanPublisherImplement::CanPublisherBase::canpub_p;
             };
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include <can_plugins/Frame.h>
+
+#include "lib/shm_ring.hpp"
+#include "message_convertor/can_plugins/Frame.hpp"
+#include "config.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        // 積んだ時刻(CLOCK_MONOTONIC)も一緒に送る。遅延の計測用。
+        struct CanShmRecord final
+        {
+            std::uint64_t stamp_ns{};
+            MessageConvertor<can_plugins::Frame> frame{};
+        };
+
+        using CanShmRing = StewLib::ShmRing<CanShmRecord, Config::CanTx::shm_ring_capacity>;
+    }
+}
@@ -0,0 +1,265 @@
+/*
+
+CanPublisherBaseが送る前に通す段。can_txに載せる前にIDごとの予定の頻度(予算)と優先度を見る。
+
+優先度(CanTxPriority):
+    mode        shirasuのcmdやtable_cloth_activeのような、モードを切り替えるもの。
+    command     table_cloth_commandやstepping_motorのような、一回きりの指令。
+    target      shirasuのtarget。毎周期送るもの。
+
+CanTxBatchで溜めたフレームは、送るときに優先度の順に並べなおす(同じ優先度の中では積んだ順)。
+なのでcmdは同じ周期に同じノードで積まれたtargetより先に出ていく。
+targetは予算(トークンバケツ)を超えていて、しかも前に通したものと同じ中身なら捨てる(ただの送りなおしなので)。
+中身が変わったものは捨てない。TargetFilterはもう送ったつもりで覚えてしまっているので、捨てると次に変わるまで届かない。
+modeとcommandは捨てずに、予算を超えた数だけ数える。
+budgetsにないIDは予算なしとして、commandとして扱う。
+
+できないこと:
+    バケツも並べなおしもノード(翻訳単位)ごとに別々。全部のノードのフレームが合流するのはcan_txの先
+    (USBCANのドライバ)で、ここでは他のノードの分は見えない。なのでstate_managerのcmdを
+    under_carriageのtargetより先に出すようなことはできないし、ノードを跨いだ予算の取り合いも見ていない。
+    またdrive_target_rateは制御周期と同じなので、今の設定ではdriveのtargetは普通は捨てられない。
+    ここで効くのは、一つのノードの中での並びと、予定より速く同じ値を送りなおしてしまったときだけ。
+
+予算は全部Config::CanTxScheduler。全部を予定の頻度で送ったときの使用率(projected_load)は
+コンパイル時に計算し、Config::CanTxScheduler::max_projected_loadを超えたらコンパイルを通さない。
+モーターを増やしたらbudgetsにも足すこと。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <ros/ros.h>
+
+#include "message_convertor/all.hpp"
+#include "shirasu_util.hpp"
+#include "config.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        // 1フレームがバスを占めるビット数の最悪値(スタッフィングとフレーム間を含む)。
+        inline constexpr std::uint32_t can_frame_bits(const std::uint8_t dlc, const bool is_extended = false) noexcept
+        {
+            const std::uint32_t g = is_extended ? 54 : 34;
+            return g + 8 * dlc + 13 + (g + 8 * dlc - 1) / 4;
+        }
+
+        // 小さいほど先に送る。
+        enum class CanTxPriority : std::uint8_t
+        {
+            mode,
+            command,
+            target
+        };
+
+        struct CanTxBudget final
+        {
+            std::uint16_t id;
+            CanTxPriority priority;
+            // 予定の頻度[Hz]
+            double rate;
+            std::uint8_t dlc;
+        };
+
+        namespace CanTxSchedulerImplement
+        {
+            using namespace Config::CanTxScheduler;
+            namespace Tx = Config::CanId::Tx;
+
+            inline constexpr CanTxBudget shirasu_cmd(const std::uint16_t bid) noexcept
+            {
+                return {bid, CanTxPriority::mode, mode_rate, 1};
+            }
+
+            inline constexpr CanTxBudget shirasu_target(const std::uint16_t bid, const double rate) noexcept
+            {
+                return {ShirasuUtil::target_id(bid), CanTxPriority::target, rate, 4};
+            }
+
+            inline constexpr CanTxBudget budgets[] =
+            {
+                shirasu_cmd(Tx::DriveMotor::FR), shirasu_target(Tx::DriveMotor::FR, drive_target_rate),
+                shirasu_cmd(Tx::DriveMotor::FL), shirasu_target(Tx::DriveMotor::FL, drive_target_rate),
+                shirasu_cmd(Tx::DriveMotor::BL), shirasu_target(Tx::DriveMotor::BL, drive_target_rate),
+                shirasu_cmd(Tx::DriveMotor::BR), shirasu_target(Tx::DriveMotor::BR, drive_target_rate),
+
+                shirasu_cmd(Tx::LiftMotor::FR), shirasu_target(Tx::LiftMotor::FR, lift_target_rate),
+                shirasu_cmd(Tx::LiftMotor::FL), shirasu_target(Tx::LiftMotor::FL, lift_target_rate),
+                shirasu_cmd(Tx::LiftMotor::BL), shirasu_target(Tx::LiftMotor::BL, lift_target_rate),
+                shirasu_cmd(Tx::LiftMotor::BR), shirasu_target(Tx::LiftMotor::BR, lift_target_rate),
+                shirasu_cmd(Tx::LiftMotor::subX), shirasu_target(Tx::LiftMotor::subX, lift_target_rate),
+                shirasu_cmd(Tx::LiftMotor::subY), shirasu_target(Tx::LiftMotor::subY, lift_target_rate),
+                shirasu_cmd(Tx::LiftMotor::collector), shirasu_target(Tx::LiftMotor::collector, lift_target_rate),
+
+                {Tx::table_cloth_active, CanTxPriority::mode, mode_rate, 1},
+                {Tx::table_cloth_command, CanTxPriority::command, command_rate, 1},
+                {Tx::stepping_motor, CanTxPriority::command, command_rate, 1}
+            };
+
+            inline constexpr std::size_t budgets_size = sizeof(budgets) / sizeof(budgets[0]);
+
+            inline constexpr bool has_unique_ids() noexcept
+            {
+                for(std::size_t i = 0; i < budgets_size; ++i)
+                {
+                    for(std::size_t j = i + 1; j < budgets_size; ++j)
+                    {
+                        if(budgets[i].id == budgets[j].id) return false;
+                    }
+                }
+                return true;
+            }
+
+            inline constexpr double projected_bits_per_sec() noexcept
+            {
+                double sum = 0;
+                for(const auto& budget : budgets) sum += budget.rate * can_frame_bits(budget.dlc);
+                return sum;
+            }
+
+            static_assert(has_unique_ids(), "CAN ids in budgets overlap.");
+
+            struct Bucket final
+            {
+                double tokens{Config::CanTxScheduler::burst};
+                std::uint64_t last_ns{0};
+                // このノードがこのIDで送った数
+                std::uint64_t frames{0};
+                // 予算を超えた数(捨てなかったものも含む)
+                std::uint64_t over_budget{0};
+                // 最後に通した中身。targetはこれと違えば予算を超えても捨てない。
+                bool has_last{false};
+                std::uint8_t last_dlc{0};
+                std::uint8_t last_data[8]{};
+            };
+        }
+
+        // 全部のIDを予定の頻度で送ったときのバスの使用率
+        inline constexpr double can_tx_projected_load = CanTxSchedulerImplement::projected_bits_per_sec() / Config::CanTx::bitrate;
+
+        static_assert(can_tx_projected_load <= Config::CanTxScheduler::max_projected_load, "CAN bus is over budget. lower the rates in Config::CanTxScheduler.");
+
+        // 静的メンバしか持たない。ノード(翻訳単位)ごとに一つ。
+        class CanTxScheduler final
+        {
+            using Frame = MessageConvertor<can_plugins::Frame>;
+            constexpr static const auto& budgets = CanTxSchedulerImplement::budgets;
+            constexpr static std::size_t budgets_size = CanTxSchedulerImplement::budgets_size;
+
+            inline static CanTxSchedulerImplement::Bucket buckets[budgets_size]{};
+
+        public:
+            CanTxScheduler() = delete;
+
+            static CanTxPriority priority(const std::uint32_t id) noexcept
+            {
+                const std::size_t index = find(id);
+                return index < budgets_size ? budgets[index].priority : CanTxPriority::command;
+            }
+
+            // 送ってよければtrue。予算を超えて、しかも前に通したものと同じ中身のtargetだけfalse。
+            // 中身が変わったtarget(0への変化など)は捨てると次に変わるまで届かないので、予算を超えても通す。
+            static bool admit(const Frame& frame) noexcept
+            {
+                const std::size_t index = find(frame.id);
+                if(index == budgets_size) return true;
+
+                auto& bucket = buckets[index];
+                const std::uint64_t now_ns = ros::Time::now().toNSec();
+
+                if(bucket.last_ns)
+                {
+                    bucket.tokens += (now_ns - bucket.last_ns) * 1e-9 * budgets[index].rate;
+                    if(bucket.tokens > Config::CanTxScheduler::burst) bucket.tokens = Config::CanTxScheduler::burst;
+                }
+                bucket.last_ns = now_ns;
+
+                if(bucket.tokens >= 1)
+                {
+                    bucket.tokens -= 1;
+                    return pass(bucket, frame);
+                }
+
+                ++bucket.over_budget;
+
+                if constexpr(Config::CanTxScheduler::enable)
+                {
+                    if(budgets[index].priority == CanTxPriority::target && is_same_as_last(bucket, frame)) return false;
+                }
+
+                return pass(bucket, frame);
+            }
+
+            // 優先度の順に並べなおす。同じ優先度の中では順番を変えない(挿入ソート。多くても64個)。
+            static void order(Frame *const frames, const std::size_t size) noexcept
+            {
+                if constexpr(!Config::CanTxScheduler::enable) return;
+
+                for(std::size_t i = 1; i < size; ++i)
+                {
+                    const Frame frame = frames[i];
+                    const CanTxPriority frame_priority = priority(frame.id);
+
+                    std::size_t j = i;
+                    for(; j > 0 && frame_priority < priority(frames[j - 1].id); --j)
+                    {
+                        frames[j] = frames[j - 1];
+                    }
+                    frames[j] = frame;
+                }
+            }
+
+            // このノードが一度でも送ったIDだけで見た、予定の使用率
+            static double active_projected_load() noexcept
+            {
+                double bits_per_sec = 0;
+                for(std::size_t i = 0; i < budgets_size; ++i)
+                {
+                    if(buckets[i].frames || buckets[i].over_budget) bits_per_sec += budgets[i].rate * can_frame_bits(budgets[i].dlc);
+                }
+                return bits_per_sec / Config::CanTx::bitrate;
+            }
+
+            static std::uint64_t over_budget_count() noexcept
+            {
+                std::uint64_t sum = 0;
+                for(const auto& bucket : buckets) sum += bucket.over_budget;
+                return sum;
+            }
+
+        private:
+            static bool pass(CanTxSchedulerImplement::Bucket& bucket, const Frame& frame) noexcept
+            {
+                ++bucket.frames;
+                bucket.has_last = true;
+                bucket.last_dlc = frame.dlc;
+                for(std::size_t i = 0; i < 8; ++i) bucket.last_data[i] = frame.data[i];
+                return true;
+            }
+
+            static bool is_same_as_last(const CanTxSchedulerImplement::Bucket& bucket, const Frame& frame) noexcept
+            {
+                if(!bucket.has_last || bucket.last_dlc != frame.dlc) return false;
+                for(std::size_t i = 0; i < frame.dlc && i < 8; ++i)
+                {
+                    if(bucket.last_data[i] != frame.data[i]) return false;
+                }
+                return true;
+            }
+
+            static std::size_t find(const std::uint32_t id) noexcept
+            {
+                for(std::size_t i = 0; i < budgets_size; ++i)
+                {
+                    if(budgets[i].id == id) return i;
+                }
+                return budgets_size;
+            }
+        };
+    }
+}
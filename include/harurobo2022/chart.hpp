@@ -1,10 +1,22 @@
+/*
+
+チャート(自動走行の手順)。
+others/chart.cppを配列としてそのまま読み込み、コンパイル時に「各位置から見て次のtransitはどれか」の表を作っておく。
+実行中は添字を進めるだけで、リストを辿ったりヒープを触ったりはしない。
+
+transitは経路の通過点で、それ以外は仕事。仕事はその通過円に入ったときに行う。
+ある通過点に着いたとき、それより前に並んでいてまだ終わっていない仕事は飛ばす。
+
+*/
+
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <list>
+#include <array>
 
-#include "../include/harurobo2022/lib/vec2d.hpp"
-#include "../include/harurobo2022/lib/circle.hpp"
+#include "lib/vec2d.hpp"
+#include "lib/circle.hpp"
 
 
 namespace Harurobo2022
@@ -36,81 +48,157 @@ namespace Harurobo2022
             Work work{Work::transit};
         };
 
+        template<std::size_t N>
+        struct CompiledChart final
+        {
+            std::array<Command, N> commands;
+            // next_transit[i]はi以降で最初のtransitの添字。なければN。
+            std::array<std::size_t, N + 1> next_transit;
+        };
+
+        template<std::size_t N>
+        constexpr CompiledChart<N> compile_chart(const Command (&commands)[N]) noexcept
+        {
+            CompiledChart<N> ret{};
+
+            for(std::size_t i = 0; i < N; ++i)
+            {
+                ret.commands[i] = commands[i];
+            }
+
+            ret.next_transit[N] = N;
+            for(std::size_t i = N; i-- > 0;)
+            {
+                ret.next_transit[i] = (commands[i].work == Work::transit) ? i : ret.next_transit[i + 1];
+            }
+
+            return ret;
+        }
+
+        // 大きさを型から消して持ち回すためのもの。中身は借りているだけ。
+        class ChartView final
+        {
+            const Command * commands_{nullptr};
+            const std::size_t * next_transit_{nullptr};
+            std::size_t size_{0};
+
+        public:
+            constexpr ChartView() = default;
+
+            constexpr ChartView(const Command *const commands, const std::size_t *const next_transit, const std::size_t size) noexcept:
+                commands_{commands},
+                next_transit_{next_transit},
+                size_{size}
+            {}
+
+            template<std::size_t N>
+            constexpr ChartView(const CompiledChart<N>& chart) noexcept:
+                ChartView(chart.commands.data(), chart.next_transit.data(), N)
+            {}
+
+            constexpr std::size_t size() const noexcept
+            {
+                return size_;
+            }
+
+            constexpr const Command& operator[](const std::size_t index) const noexcept
+            {
+                return commands_[index];
+            }
+
+            constexpr std::size_t next_transit(const std::size_t index) const noexcept
+            {
+                return next_transit_[index];
+            }
+
+            constexpr const Command * begin() const noexcept
+            {
+                return commands_;
+            }
+
+            constexpr const Command * end() const noexcept
+            {
+                return commands_ + size_;
+            }
+        };
+
         namespace StaticChart
         {
-            // スタートは入れずゴールを入れる。
-            inline std::list<Command> chart1
+            namespace StaticChartImplement
             {
-                #include "../../others/chart.cpp"
-            };
+                // スタートは入れずゴールを入れる。
+                inline constexpr Command chart1_source[]
+                {
+                    #include "../../others/chart.cpp"
+                };
+            }
+
+            inline constexpr auto chart1 = compile_chart(StaticChartImplement::chart1_source);
         }
 
-        struct ChartManager final
+        class ChartManager final
         {
-            // debug
-            std::list<Command> chart{StaticChart::chart1};
+        public:
+            ChartView chart{StaticChart::chart1};
 
+        private:
+            // 直近の仕事(目標姿勢角もここから取る)
+            std::size_t current_work{0};
+            // 目標位置
+            std::size_t target_position{chart.next_transit(0)};
+
+        public:
             void reset_chart() noexcept
             {
-                /* TODO 動的な軌道変更*/
+                current_work = 0;
+                target_position = chart.next_transit(0);
             }
 
-            // 目標姿勢角と直近の仕事
-            std::list<Command>::const_iterator current_work;
-            // 目標位置
-            std::list<Command>::const_iterator target_position;
+            void change_chart(const ChartView& changed_chart) noexcept
+            {
+                chart = changed_chart;
+                reset_chart();
+            }
+
+            bool has_current_work() const noexcept
+            {
+                return current_work < chart.size();
+            }
+
+            bool has_target_position() const noexcept
+            {
+                return target_position < chart.size();
+            }
+
+            // has_current_work()がfalseなら最後のものを返す。
+            const Command& get_current_work() const noexcept
+            {
+                return chart[has_current_work() ? current_work : chart.size() - 1];
+            }
+
+            const Command& get_target_position() const noexcept
+            {
+                return chart[target_position];
+            }
 
             void current_work_update() noexcept
             {
                 ++current_work;
             }
 
-            void target_position_update() noexcept
+            // 今の目標に着いたら次のtransitへ。返り値は飛ばした仕事の数。
+            std::size_t target_position_update() noexcept
             {
-                auto iter = target_position;
-                for(;iter != chart.cend(); ++iter)
+                std::size_t skipped = 0;
+                if(current_work <= target_position)
                 {
-                    if(iter->work == Work::transit)
-                    {
-                        target_position = iter;
-                        current_work = iter;
-                        break;
-                    }
+                    skipped = target_position - current_work;
+                    current_work = target_position + 1;
                 }
+
+                target_position = chart.next_transit(target_position + 1);
+                return skipped;
             }
         };
-
-    //     namespace ChartImplement
-    //     {
-    //         std::list<Command> make_trajectory(std::list<Command> chart) noexcept
-    //         {
-    //             chart.remove_if([](const Command& command) noexcept {return command.work != Work::transit;});
-    //             return chart;
-    //         }
-
-    //         std::list<std::list<Command>> make_steps(const std::list<Command>& chart) noexcept
-    //         {
-    //             std::list<std::list<Command>> steps;
-    //             steps.emplace_back();
-    //             auto part_steps = steps.end();
-    //             --part_steps;
-
-    //             for(const auto& command: chart)
-    //             {
-    //                 if(command.work == Work::transit)
-    //                 {
-    //                     steps.emplace_back();
-    //                     ++part_steps;
-    //                 }
-
-    //                 part_steps->emplace_back(command);
-    //             }
-
-    //             return steps;
-    //         }
-    //     }
-
-    //     inline std::list<Command> trajectory = ChartImplement::make_trajectory(ChartImplement::chart);
-    //     inline std::list<std::list<Command>> steps = ChartImplement::make_steps(ChartImplement::chart);
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include "lib/vec2d.hpp"
@@ -46,15 +47,17 @@ namespace Harurobo2022
 
             namespace Limitation
             {
-                // 0に設定すると制限がかからなくなる。
+                // 0に設定すると制限がかからなくなる。ホイールの角速度[rad/s]、角加速度[rad/s^2]、角加加速度[rad/s^3]。
                 inline constexpr double wheel_vela{/*TODO*/90};
-                inline constexpr double wheel_acca{/*TODO*/90};
+                inline constexpr double wheel_acca{/*TODO*/900};
+                inline constexpr double wheel_jerk{/*TODO*/0};
             
                 inline constexpr double body_vell_ratio{/*TODO*/0.5};
                 inline constexpr double body_vela_ratio{/*TODO*/0.5};
 
                 inline constexpr double body_vell{wheel_vela * body_vell_ratio * wheel_radius};
                 inline constexpr double body_vela{wheel_vela * body_vela_ratio * wheel_radius / body_radius};
+                inline constexpr double body_accl{wheel_acca * body_vell_ratio * wheel_radius};
             }
 
 
@@ -65,6 +68,24 @@ namespace Harurobo2022
                 inline constexpr double auto_commander_freq{1000};
             }
 
+            namespace RtExecutor
+            {
+                // trueにすると足回りと指令系のノードは周期処理をRtExecutorで回す。falseならros::Timer。
+                inline constexpr bool enable{true};
+                // 1~99にするとSCHED_FIFOになる。0なら普通のスケジューリングのまま。
+                inline constexpr int sched_priority{/*TODO*/0};
+                // ジッタとオーバーランを報告する間隔[s]
+                inline constexpr double report_interval{5};
+
+                // 張り付けるCPU。負なら張り付けない。
+                namespace Cpu
+                {
+                    inline constexpr int under_carriage{/*TODO*/-1};
+                    inline constexpr int manual_commander{/*TODO*/-1};
+                    inline constexpr int auto_commander{/*TODO*/-1};
+                }
+            }
+
             namespace Pid
             {
                 inline constexpr double position_k_p{/*TODO*/10};
@@ -74,6 +95,28 @@ namespace Harurobo2022
                 inline constexpr double rot_z_k_p{/*TODO*/10};
                 inline constexpr double rot_z_k_i{/*TODO*/0};
                 inline constexpr double rot_z_k_d{/*TODO*/0};
+
+                // 微分にかける一次遅れの時定数[s]。0ならかけない。
+                inline constexpr double position_derivative_tau{/*TODO*/0.01};
+                inline constexpr double rot_z_derivative_tau{/*TODO*/0.01};
+
+                // 目標速度と推定速度の差にかけるゲイン。速度のフィードバック。
+                inline constexpr double velocity_k_p{/*TODO*/0.2};
+            }
+
+            namespace Estimator
+            {
+                // オドメトリから位置と速度を推定するα-βフィルタの係数。
+                inline constexpr double alpha{/*TODO*/0.5};
+                inline constexpr double beta{/*TODO*/0.1};
+                // 最後のオドメトリからこれ[s]より先へは外挿しない。
+                inline constexpr double max_extrapolation{/*TODO*/0.05};
+            }
+
+            namespace Trajectory
+            {
+                // 目標からこれ[mm]より離れたら、追いつくまで目標を進めない。
+                inline constexpr double max_tracking_error{/*TODO*/100};
             }
 
             namespace InitialState
@@ -82,6 +125,95 @@ namespace Harurobo2022
                 inline constexpr double rot_z{/*TODO*/ -StewLib::Constant::PI / 4};
             }
 
+            namespace Profiling
+            {
+                // falseにするとTimerとSubscriberのコールバックを測らない。
+                inline constexpr bool enable{true};
+                // 終了時に結果を書き出すディレクトリ
+                inline constexpr const char * dump_dir{"/tmp"};
+            }
+
+            namespace Tracing
+            {
+                // trueにするとジョイスティックからCANフレームまでの時刻を記録する(trace.hpp)。
+                inline constexpr bool enable{false};
+                // 記録を溜めておく数。溢れた分は捨てる。
+                inline constexpr std::size_t capacity{1 << 18};
+                // 終了時に書き出すディレクトリ
+                inline constexpr const char * dir{"/tmp"};
+            }
+
+            namespace CanTx
+            {
+                // trueにするとcan_shm_bridgeが動いている間は共有メモリのリング経由で送る。いなければROSのトピックで送る。
+                inline constexpr bool use_shm_ring{false};
+                inline constexpr const char * shm_ring_name{"/harurobo2022_can_tx"};
+                inline constexpr std::size_t shm_ring_capacity{1024};
+                // 読む側の生存確認が途絶えてからROSに戻すまでの時間[s]
+                inline constexpr double shm_consumer_timeout{0.1};
+                // バスの速さ[bit/s]。使用率の計算用。
+                inline constexpr std::uint32_t bitrate{1'000'000};
+                // 使用率を出す間隔[s]
+                inline constexpr double load_report_interval{5};
+            }
+
+            namespace CanTxScheduler
+            {
+                // falseにすると並べ替えも間引きもせず、来た順に全部送る(数えるだけ)。
+                inline constexpr bool enable{true};
+                // IDごとの予定の頻度[Hz]。これを超えたtargetのフレームは、前に通したものと同じ中身なら捨てる。cmdなどは超えても捨てずに数えるだけ。
+                // バケツはノードごとなので、driveは制御周期と同じにしてあって普通は捨てない。
+                inline constexpr double drive_target_rate{1000};
+                inline constexpr double lift_target_rate{/*TODO*/100};
+                inline constexpr double mode_rate{/*TODO*/10};
+                inline constexpr double command_rate{/*TODO*/10};
+                // 予定の頻度を超えてまとめて送ってよいフレームの数
+                inline constexpr double burst{4};
+                // 予定の頻度で全部送ったときのバスの使用率がこれを超えたらコンパイルを通さない。
+                inline constexpr double max_projected_load{0.8};
+            }
+
+            namespace TargetFilter
+            {
+                // shirasuへのtargetを、前に送った値から変わっていなければ送らない(shirasu_publisher.hpp)。
+                namespace Drive
+                {
+                    inline constexpr bool enable{true};
+                    // 前に送った値からこれ[rad/s]より大きく変わったら送る。0なら少しでも変われば。
+                    inline constexpr double deadband{/*TODO*/0.01};
+                    // 変わらなくてもこれ[s]ごとには送る。shirasuのウォッチドッグより短くすること。
+                    inline constexpr double keep_alive{/*TODO*/0.05};
+                }
+            }
+
+            namespace DebugMirror
+            {
+                // CanPublisherがCANに送った値を、デバッグ用のトピック(FR_drive_targetなど)にも流すか(debug_mirror.hpp)。
+                // "off", "always", "decimate", "on_change"。ノードごとにros paramの~debug_mirrorで変えられる。
+                inline constexpr const char * mode{"off"};
+                // decimateのとき、何回に1回流すかと、最大の頻度[Hz](0なら見ない)。
+                inline constexpr std::uint32_t decimation{10};
+                inline constexpr double max_rate{50};
+                inline constexpr std::uint32_t queue_size{10};
+            }
+
+            namespace CanRx
+            {
+                // 複数フレームに分かれたデータで、フレーム間(受け取った時刻の差)がこれ[s]より空いたら組み立てなおす。
+                // USB-CAN(slcan)はUSBのポーリングで1msくらいずつまとめて届き、ばらつきもあるので、それより十分長くする。
+                inline constexpr double reassembly_timeout{/*TODO*/0.005};
+            }
+
+            namespace CanLog
+            {
+                // can_recorderの書き出し先(ros paramの/can_recorder/pathで変えられる)と、記録できる数。溢れた分は捨てる。
+                inline constexpr const char * path{"/tmp/harurobo2022_can.log"};
+                inline constexpr std::size_t capacity{1 << 21};
+                // can_replayerを最速で流すとき、これだけ流したら少し待つ。can_subscriberのキュー(1000)を溢れさせないため。
+                inline constexpr std::size_t replay_burst{500};
+                inline constexpr double replay_burst_interval{0.001};
+            }
+
             namespace CanId
             {
                 namespace Tx
@@ -119,9 +251,11 @@ namespace Harurobo2022
 
                 namespace Rx
                 {
-                    inline constexpr std::uint16_t odometry_x{/*TODO*/0x205};
-                    inline constexpr std::uint16_t odometry_y{/*TODO*/0x206};
-                    inline constexpr std::uint16_t odometry_yaw{/*TODO*/0x207};
+                    // {pos_x, pos_y, rot_z}をまとめて2フレームで送ってもらう。
+                    inline constexpr std::uint16_t odometry{/*TODO*/0x205};
+                    // 受け取っても捨てるだけのID。知らないIDとして数えない(警告も出さない)。
+                    // 1058はデバッグ用の基板が流しているもの。
+                    inline constexpr std::uint16_t ignored[]{1058};
                 }
             }
         }
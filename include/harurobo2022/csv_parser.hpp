@@ -1,32 +1,418 @@
+/*
+
+チャートをファイルから読む。チャートを変えるたびにビルドし直さなくて済むように。
+
+テキスト(csv)は1行1命令で、
+    中心x, 中心y, 半径, 目標姿勢角, 仕事
+仕事はWorkの名前(transitとか)か数字。空行と#から後ろは無視する。
+
+バイナリは先頭16バイトがヘッダ(magic "HR22CHRT", 版, 命令の数)で、その後ろにCommandがそのまま並ぶ。
+mmapしてそのまま指すので読み込みは一瞬。エンディアンと詰め物は書いた機械のもの(NUCで書いてNUCで読む前提)。
+tools/chart_convertでcsvから作れる。
+
+おかしなところがあれば何行目何列目(どちらも1から)かをChartErrorに入れて返す。
+バイナリのときは行は命令の番号(1から)、列はその命令の中のバイト位置。
+
+*/
+
 #pragma once
 
-#include <list>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <charconv>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <optional>
+#include <utility>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "chart.hpp"
 
 namespace Harurobo2022
 {
     namespace
     {
+        struct ChartError final
+        {
+            std::size_t line{0};
+            std::size_t column{0};
+            const char * what{""};
+        };
 
-    namespace CSVParser::Implement
-    {
-
-        // 括弧付きの適格とは限らない文字列が入る
-        inline std::string split_comma(std::string& src) noexcept
+        namespace CsvParserImplement
         {
-            const auto len = src.size();
+            inline constexpr char magic[8] = {'H', 'R', '2', '2', 'C', 'H', 'R', 'T'};
+            inline constexpr std::uint32_t version = 1;
+
+            struct BinaryHeader final
+            {
+                char magic[8];
+                std::uint32_t version;
+                std::uint32_t count;
+            };
+
+            static_assert(sizeof(BinaryHeader) == 16);
+            static_assert(std::is_trivially_copyable_v<Command>);
+            static_assert(sizeof(BinaryHeader) % alignof(Command) == 0);
+
+            inline constexpr std::pair<std::string_view, Work> work_names[] =
+            {
+                {"transit", Work::transit},
+                {"collector_bottom", Work::collector_bottom},
+                {"collector_step1", Work::collector_step1},
+                {"collector_step2", Work::collector_step2},
+                {"collector_step3", Work::collector_step3},
+                {"collector_shovel_open", Work::collector_shovel_open},
+                {"collector_shovel_close", Work::collector_shovel_close},
+                {"collector_tablecloth_push", Work::collector_tablecloth_push},
+                {"collector_tablecloth_pull", Work::collector_tablecloth_pull},
+                {"change_to_over_fence", Work::change_to_over_fence},
+                {"game_clear", Work::game_clear}
+            };
+
+            constexpr bool is_valid_work(const std::uint8_t value) noexcept
+            {
+                return value <= static_cast<std::uint8_t>(Work::game_clear);
+            }
+
+            constexpr bool is_space(const char c) noexcept
+            {
+                return c == ' ' || c == '\t' || c == '\r';
+            }
+
+            // [first, last)の前後の空白を削る。
+            inline std::string_view trim(const char * first, const char * last) noexcept
+            {
+                while(first != last && is_space(*first)) ++first;
+                while(first != last && is_space(*(last - 1))) --last;
+                return {first, static_cast<std::size_t>(last - first)};
+            }
+
+            // fieldは末尾がヌル文字か区切りで終わっている文字列の一部であること(strtofのため)。
+            inline bool parse_float(const std::string_view field, float& value) noexcept
+            {
+                if(field.empty()) return false;
+                const char *const last = field.data() + field.size();
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+                const auto [ptr, ec] = std::from_chars(field.data(), last, value);
+                return ec == std::errc{} && ptr == last;
+#else
+                // GCC 10まではfloatのfrom_charsがない。
+                char * end;
+                value = std::strtof(field.data(), &end);
+                return end == last;
+#endif
+            }
 
-            if(len < 2 || src[0] != '{' || src[len - 2] != '}')
+            inline bool parse_work(const std::string_view field, Work& work) noexcept
             {
-                
+                for(const auto& [name, value] : work_names)
+                {
+                    if(field == name)
+                    {
+                        work = value;
+                        return true;
+                    }
+                }
+
+                unsigned int value;
+                const char *const last = field.data() + field.size();
+                const auto [ptr, ec] = std::from_chars(field.data(), last, value);
+                if(ec != std::errc{} || ptr != last || value > 0xFF || !is_valid_work(value)) return false;
+
+                work = static_cast<Work>(value);
+                return true;
             }
         }
 
-        template <class T>
-        inline std::list<T> csv_parser(const std::stirng& src) noexcept
+        // 読み込んだチャートの持ち主。view()で得たChartViewはこれが生きている間だけ使える。
+        class ChartFile final
         {
+            std::vector<Command> owned{};
+            std::vector<std::size_t> next_transit{};
+            const Command * commands{nullptr};
+            std::size_t size{0};
 
-        }
+            void * mapped{nullptr};
+            std::size_t mapped_size{0};
+
+        public:
+            ChartFile() = default;
+
+            ChartFile(ChartFile&& other) noexcept:
+                owned{std::move(other.owned)},
+                next_transit{std::move(other.next_transit)},
+                commands{std::exchange(other.commands, nullptr)},
+                size{std::exchange(other.size, 0)},
+                mapped{std::exchange(other.mapped, nullptr)},
+                mapped_size{std::exchange(other.mapped_size, 0)}
+            {}
+
+            ChartFile& operator=(ChartFile&& other) noexcept
+            {
+                if(this != &other)
+                {
+                    unmap();
+                    owned = std::move(other.owned);
+                    next_transit = std::move(other.next_transit);
+                    commands = std::exchange(other.commands, nullptr);
+                    size = std::exchange(other.size, 0);
+                    mapped = std::exchange(other.mapped, nullptr);
+                    mapped_size = std::exchange(other.mapped_size, 0);
+                }
+                return *this;
+            }
+
+            ~ChartFile() noexcept
+            {
+                unmap();
+            }
+
+            ChartView view() const noexcept
+            {
+                return {commands, next_transit.data(), size};
+            }
+
+            // 先頭がmagicならバイナリ、でなければcsvとして読む。
+            static std::optional<ChartFile> load(const char *const path, ChartError& error) noexcept
+            {
+                const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+                if(fd < 0)
+                {
+                    error = {0, 0, "cannot open file."};
+                    return std::nullopt;
+                }
+
+                struct stat st;
+                if(::fstat(fd, &st) != 0)
+                {
+                    ::close(fd);
+                    error = {0, 0, "cannot stat file."};
+                    return std::nullopt;
+                }
+                const std::size_t file_size = st.st_size;
+
+                char head[sizeof(CsvParserImplement::magic)]{};
+                const bool is_binary = ::pread(fd, head, sizeof(head), 0) == static_cast<ssize_t>(sizeof(head))
+                    && std::memcmp(head, CsvParserImplement::magic, sizeof(head)) == 0;
+
+                std::optional<ChartFile> ret = is_binary ? load_binary(fd, file_size, error) : load_text(fd, file_size, error);
+                ::close(fd);
+
+                if(ret)
+                {
+                    if(!ret->size)
+                    {
+                        error = {0, 0, "chart is empty."};
+                        return std::nullopt;
+                    }
+                    ret->make_next_transit();
+                }
+
+                return ret;
+            }
+
+            // viewをバイナリで書き出す。
+            static bool write_binary(const char *const path, const ChartView& chart) noexcept
+            {
+                std::FILE *const file = std::fopen(path, "wb");
+                if(!file) return false;
+
+                CsvParserImplement::BinaryHeader header{};
+                std::memcpy(header.magic, CsvParserImplement::magic, sizeof(header.magic));
+                header.version = CsvParserImplement::version;
+                header.count = chart.size();
+
+                bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+                if(chart.size()) ok = ok && std::fwrite(chart.begin(), sizeof(Command), chart.size(), file) == chart.size();
+
+                return (std::fclose(file) == 0) && ok;
+            }
+
+        private:
+            void unmap() noexcept
+            {
+                if(mapped)
+                {
+                    ::munmap(mapped, mapped_size);
+                    mapped = nullptr;
+                    mapped_size = 0;
+                }
+            }
+
+            void make_next_transit() noexcept
+            {
+                next_transit.assign(size + 1, size);
+                for(std::size_t i = size; i-- > 0;)
+                {
+                    next_transit[i] = (commands[i].work == Work::transit) ? i : next_transit[i + 1];
+                }
+            }
+
+            static std::optional<ChartFile> load_binary(const int fd, const std::size_t file_size, ChartError& error) noexcept
+            {
+                using namespace CsvParserImplement;
+
+                if(file_size < sizeof(BinaryHeader))
+                {
+                    error = {0, 0, "header is truncated."};
+                    return std::nullopt;
+                }
+
+                void *const p = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p == MAP_FAILED)
+                {
+                    error = {0, 0, "mmap failed."};
+                    return std::nullopt;
+                }
+
+                ChartFile ret{};
+                ret.mapped = p;
+                ret.mapped_size = file_size;
+
+                BinaryHeader header;
+                std::memcpy(&header, p, sizeof(header));
+
+                if(header.version != version)
+                {
+                    error = {0, offsetof(BinaryHeader, version) + 1, "unsupported version."};
+                    return std::nullopt;
+                }
+
+                if(file_size != sizeof(BinaryHeader) + std::size_t{header.count} * sizeof(Command))
+                {
+                    error = {0, offsetof(BinaryHeader, count) + 1, "count does not match file size."};
+                    return std::nullopt;
+                }
+
+                const auto *const commands = reinterpret_cast<const Command *>(static_cast<const char *>(p) + sizeof(BinaryHeader));
+                for(std::size_t i = 0; i < header.count; ++i)
+                {
+                    if(!is_valid_work(static_cast<std::uint8_t>(commands[i].work)))
+                    {
+                        error = {i + 1, offsetof(Command, work) + 1, "unknown work."};
+                        return std::nullopt;
+                    }
+                    if(!(commands[i].pass_near_circle.range > 0))
+                    {
+                        error = {i + 1, offsetof(Command, pass_near_circle.range) + 1, "range must be positive."};
+                        return std::nullopt;
+                    }
+                }
+
+                ret.commands = commands;
+                ret.size = header.count;
+                return ret;
+            }
+
+            static std::optional<ChartFile> load_text(const int fd, const std::size_t file_size, ChartError& error) noexcept
+            {
+                using namespace CsvParserImplement;
+
+                // 末尾にヌル文字が要るのでmmapではなく読み込む。
+                std::string src(file_size, '\0');
+                std::size_t done = 0;
+                while(done < file_size)
+                {
+                    const ssize_t n = ::read(fd, src.data() + done, file_size - done);
+                    if(n <= 0)
+                    {
+                        error = {0, 0, "read failed."};
+                        return std::nullopt;
+                    }
+                    done += n;
+                }
+
+                ChartFile ret{};
+
+                const char *const begin = src.c_str();
+                const char *const end = begin + src.size();
+                std::size_t line = 0;
+
+                for(const char * line_begin = begin; line_begin < end;)
+                {
+                    ++line;
+                    const char * line_end = static_cast<const char *>(std::memchr(line_begin, '\n', end - line_begin));
+                    if(!line_end) line_end = end;
+                    const char *const next_line = line_end + 1;
+
+                    if(const void *const comment = std::memchr(line_begin, '#', line_end - line_begin)) line_end = static_cast<const char *>(comment);
+
+                    if(trim(line_begin, line_end).empty())
+                    {
+                        line_begin = next_line;
+                        continue;
+                    }
+
+                    // 列はフィールドの頭(空白を飛ばしたあと)の位置。
+                    std::string_view fields[5];
+                    std::size_t columns[5];
+                    std::size_t n_fields = 0;
+                    for(const char * field_begin = line_begin;;)
+                    {
+                        const char * field_end = static_cast<const char *>(std::memchr(field_begin, ',', line_end - field_begin));
+                        const bool is_last = !field_end;
+                        if(is_last) field_end = line_end;
+
+                        if(n_fields == 5)
+                        {
+                            error = {line, static_cast<std::size_t>(field_begin - line_begin) + 1, "too many fields."};
+                            return std::nullopt;
+                        }
+                        fields[n_fields] = trim(field_begin, field_end);
+                        columns[n_fields] = (field_begin == field_end ? field_begin : fields[n_fields].data()) - line_begin + 1;
+                        ++n_fields;
+
+                        if(is_last) break;
+                        field_begin = field_end + 1;
+                    }
+
+                    if(n_fields != 5)
+                    {
+                        error = {line, static_cast<std::size_t>(line_end - line_begin) + 1, "expected 5 fields: x, y, range, rot_z, work."};
+                        return std::nullopt;
+                    }
+
+                    Command command{};
+                    float * const floats[4] = {&command.pass_near_circle.center.x, &command.pass_near_circle.center.y, &command.pass_near_circle.range, &command.target_rot_z};
+                    for(std::size_t i = 0; i < 4; ++i)
+                    {
+                        if(!parse_float(fields[i], *floats[i]))
+                        {
+                            error = {line, columns[i], "invalid number."};
+                            return std::nullopt;
+                        }
+                    }
+
+                    if(!(command.pass_near_circle.range > 0))
+                    {
+                        error = {line, columns[2], "range must be positive."};
+                        return std::nullopt;
+                    }
+
+                    if(!parse_work(fields[4], command.work))
+                    {
+                        error = {line, columns[4], "unknown work."};
+                        return std::nullopt;
+                    }
+
+                    ret.owned.push_back(command);
+                    line_begin = next_line;
+                }
+
+                ret.commands = ret.owned.data();
+                ret.size = ret.owned.size();
+                return ret;
+            }
+        };
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,224 @@
+/*
+
+CanPublisherがCANに送った値を、デバッグ用のトピック(FR_drive_targetなど)にも流すためのもの。
+前はcan_publishのたびに必ず流していて、ROSの通信が倍になっていた。
+
+流し方(MirrorMode):
+    off         流さない。advertiseもしない。
+    always      毎回流す。
+    decimate    Config::DebugMirror::decimation回に1回、かつ最大max_rate[Hz]。
+    on_change   前に流した値と違うときだけ。
+
+既定はConfig::DebugMirror::mode。ノードごとにros paramの~debug_mirrorで変えられる(起動時に一度だけ読む)。
+nodeletならnodeletのプライベートな名前空間(ThisNode::get_name())の~debug_mirrorで、マネージャのものではない。
+offでなければadvertiseしておくが、購読者の数をros::SubscriberStatusCallbackで数えておき、
+誰も見ていなければメッセージを作らない(シリアライズもしない)。
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <ros/ros.h>
+#include <boost/make_shared.hpp>
+
+#include "topic.hpp"
+#include "config.hpp"
+#include "this_node.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        enum class MirrorMode : std::uint8_t
+        {
+            off,
+            always,
+            decimate,
+            on_change
+        };
+
+        namespace DebugMirrorImplement
+        {
+            inline bool parse(const std::string_view str, MirrorMode& mode) noexcept
+            {
+                constexpr std::string_view names[] = {"off", "always", "decimate", "on_change"};
+
+                for(std::uint8_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+                {
+                    if(str == names[i])
+                    {
+                        mode = static_cast<MirrorMode>(i);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // ノード(翻訳単位)ごとに一度だけ読む。
+            inline MirrorMode load_mode() noexcept
+            {
+                MirrorMode mode{MirrorMode::off};
+                if(!parse(Config::DebugMirror::mode, mode))
+                {
+                    ROS_ERROR("debug_mirror: unknown mode %s in Config::DebugMirror::mode.", Config::DebugMirror::mode);
+                }
+
+                std::string str{};
+                if(ros::param::get(ThisNode::get_name() + "/debug_mirror", str) && !parse(str, mode))
+                {
+                    ROS_ERROR("debug_mirror: unknown mode %s. use off, always, decimate or on_change.", str.c_str());
+                }
+
+                return mode;
+            }
+
+            inline MirrorMode mode() noexcept
+            {
+                static const MirrorMode mode = load_mode();
+                return mode;
+            }
+        }
+
+        template<class Topic_>
+        class DebugMirror final
+        {
+        public:
+            using Topic = Topic_;
+            using Message = Topic::Message;
+            using MessageConvertor = Topic::MessageConvertor;
+            using TopicName = Topic::Name;
+
+        private:
+            using RawData = MessageConvertor::RawData;
+
+            // 購読者の数。コールバックはスピナーのスレッドから呼ばれるので、publisherより長生きするよう共有する。
+            struct Connection final
+            {
+                std::atomic<std::uint32_t> subscriber_count{0};
+                // 新しく購読者が来たらon_changeでも次の値を流す。
+                std::atomic<bool> is_resend_requested{false};
+            };
+
+            ros::NodeHandle nh{};
+            std::uint32_t queue_size;
+            MirrorMode mode{DebugMirrorImplement::mode()};
+            std::shared_ptr<Connection> connection{std::make_shared<Connection>()};
+            ros::Publisher pub{};
+
+            std::uint32_t call_count{0};
+            ros::Time last_stamp{};
+            RawData last_raw_data{};
+            bool has_last{false};
+
+        public:
+            DebugMirror(const std::uint32_t queue_size) noexcept:
+                queue_size{queue_size}
+            {
+                activate();
+            }
+
+            DebugMirror(const DebugMirror&) = delete;
+            DebugMirror& operator=(const DebugMirror&) = delete;
+            DebugMirror(DebugMirror&&) = delete;
+            DebugMirror& operator=(DebugMirror&&) = delete;
+
+            void publish(const MessageConvertor& conv) noexcept
+            {
+                if(!pub || !connection->subscriber_count.load(std::memory_order_relaxed)) return;
+
+                if(!should_publish(conv)) return;
+
+#ifdef HARUROBO2022_NODELET
+                pub.publish(boost::make_shared<const Message>(static_cast<Message>(conv)));
+#else
+                pub.publish(static_cast<Message>(conv));
+#endif
+            }
+
+            MirrorMode get_mode() const noexcept
+            {
+                return mode;
+            }
+
+            ros::Publisher get_pub() const noexcept
+            {
+                return pub;
+            }
+
+            void deactivate() noexcept
+            {
+                pub = ros::Publisher();
+                connection->subscriber_count = 0;
+            }
+
+            void activate() noexcept
+            {
+                if(mode == MirrorMode::off) return;
+
+                const ros::SubscriberStatusCallback connect_cb = [connection = connection](const ros::SingleSubscriberPublisher&) noexcept
+                {
+                    ++connection->subscriber_count;
+                    connection->is_resend_requested = true;
+                };
+                const ros::SubscriberStatusCallback disconnect_cb = [connection = connection](const ros::SingleSubscriberPublisher&) noexcept
+                {
+                    if(connection->subscriber_count) --connection->subscriber_count;
+                };
+
+                connection->subscriber_count = 0;
+                pub = nh.advertise<Message>(TopicName::str, queue_size, connect_cb, disconnect_cb);
+            }
+
+        private:
+            bool should_publish(const MessageConvertor& conv) noexcept
+            {
+                switch(mode)
+                {
+                case MirrorMode::always:
+                    return true;
+
+                case MirrorMode::decimate:
+                {
+                    if(++call_count < Config::DebugMirror::decimation) return false;
+
+                    if constexpr(Config::DebugMirror::max_rate > 0)
+                    {
+                        const ros::Time now = ros::Time::now();
+                        if(has_last && (now - last_stamp).toSec() < 1.0 / Config::DebugMirror::max_rate) return false;
+                        last_stamp = now;
+                        has_last = true;
+                    }
+
+                    call_count = 0;
+                    return true;
+                }
+
+                case MirrorMode::on_change:
+                {
+                    if constexpr(std::is_trivially_copyable_v<RawData>)
+                    {
+                        const RawData raw_data = conv;
+                        const bool is_resend = connection->is_resend_requested.exchange(false);
+                        if(has_last && !is_resend && std::memcmp(&raw_data, &last_raw_data, sizeof(RawData)) == 0) return false;
+
+                        last_raw_data = raw_data;
+                        has_last = true;
+                    }
+                    return true;
+                }
+
+                default:
+                    return false;
+                }
+            }
+        };
+    }
+}
@@ -4,5 +4,6 @@
 
 Stew_define_has_member(activate, activate)
 Stew_define_has_member(deactivate, deactivate)
+Stew_define_has_member(stamp, stamp)
 
 #undef Stew_define_has_member
\ No newline at end of file
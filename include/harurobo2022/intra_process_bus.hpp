@@ -0,0 +1,174 @@
+/*
+
+同じプロセス内だけで完結するトピックの受け渡し。roscppのキューもシリアライズも通さない。
+nodelet(HARUROBO2022_NODELET)としてビルドしたときだけ使われる。別プロセスだと届かないので。
+
+トピックごとにチャンネルが一つあって、
+・最新値をseqlockで持つ(何本から読まれてもよい)
+・購読者のコールバックを登録しておき、publishしたスレッドでその場で呼ぶ
+をする。ROS側には外から購読している人(rostopic echoとか)がいるときだけ流す。
+
+nodeletは別々の翻訳単位なので、無名名前空間の型をキーにすると共有できない。
+なのでここだけは名前付きの名前空間に置き、トピック名の文字列で一度だけ引いてポインタを覚えておく。
+RawDataも無名名前空間の型なので、チャンネルはメッセージ型とRawDataの大きさだけで決め、中身はバイト列として扱う。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+
+namespace Harurobo2022::IntraProcessBus
+{
+    template<class Message, std::size_t raw_size>
+    class Channel final
+    {
+    public:
+        using ConstPtr = typename Message::ConstPtr;
+        using Callback = std::function<void(const ConstPtr&)>;
+
+        constexpr static std::size_t max_subscribers = 8;
+
+    private:
+        // 生のメモリをそのまま競合させると未定義なので、アトミックな語の並びとしてコピーする。
+        constexpr static std::size_t words_size = (raw_size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<std::uint64_t> words[words_size]{};
+        std::atomic<const Callback *> subscribers[max_subscribers]{};
+
+    public:
+        // raw_dataはトリビアルにコピー可能なRawDataを指すこと。
+        void store(const void *const raw_data) noexcept
+        {
+            std::uint64_t buffer[words_size]{};
+            std::memcpy(buffer, raw_data, raw_size);
+
+            // 書き手が複数いてもよいよう、奇数にできた人だけが書く。
+            std::uint64_t seq = sequence.load(std::memory_order_relaxed);
+            while((seq & 1) || !sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                seq = sequence.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for(std::size_t i = 0; i < words_size; ++i)
+            {
+                words[i].store(buffer[i], std::memory_order_relaxed);
+            }
+
+            sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        void load(void *const raw_data) const noexcept
+        {
+            std::uint64_t buffer[words_size];
+            std::uint64_t seq0, seq1;
+
+            do
+            {
+                seq0 = sequence.load(std::memory_order_acquire);
+                for(std::size_t i = 0; i < words_size; ++i)
+                {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                seq1 = sequence.load(std::memory_order_relaxed);
+            }
+            while((seq0 & 1) || seq0 != seq1);
+
+            std::memcpy(raw_data, buffer, raw_size);
+        }
+
+        bool has_subscribers() const noexcept
+        {
+            for(const auto& subscriber : subscribers)
+            {
+                if(subscriber.load(std::memory_order_acquire)) return true;
+            }
+            return false;
+        }
+
+        void dispatch(const ConstPtr& msg_p) const noexcept
+        {
+            for(const auto& subscriber : subscribers)
+            {
+                if(const Callback *const callback = subscriber.load(std::memory_order_acquire))
+                {
+                    (*callback)(msg_p);
+                }
+            }
+        }
+
+        bool subscribe(const Callback *const callback) noexcept
+        {
+            for(auto& subscriber : subscribers)
+            {
+                const Callback * expected = nullptr;
+                if(subscriber.compare_exchange_strong(expected, callback, std::memory_order_acq_rel)) return true;
+            }
+            return false;
+        }
+
+        void unsubscribe(const Callback *const callback) noexcept
+        {
+            for(auto& subscriber : subscribers)
+            {
+                const Callback * expected = callback;
+                subscriber.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+            }
+        }
+    };
+
+    namespace Implement
+    {
+        struct Entry final
+        {
+            std::type_index type;
+            std::shared_ptr<void> channel;
+        };
+
+        inline std::mutex& registry_mutex() noexcept
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        inline std::map<std::string, Entry>& registry() noexcept
+        {
+            static std::map<std::string, Entry> registry;
+            return registry;
+        }
+    }
+
+    // 構築時に一度だけ呼ぶこと。型が食い違っていたらnullptrが返る。
+    template<class Message, std::size_t raw_size>
+    std::shared_ptr<Channel<Message, raw_size>> get_channel(const char *const topic_name) noexcept
+    {
+        using ChannelType = Channel<Message, raw_size>;
+
+        std::lock_guard lock{Implement::registry_mutex()};
+        auto& registry = Implement::registry();
+
+        const auto iter = registry.find(topic_name);
+        if(iter == registry.end())
+        {
+            auto channel = std::make_shared<ChannelType>();
+            registry.emplace(topic_name, Implement::Entry{typeid(ChannelType), channel});
+            return channel;
+        }
+
+        if(iter->second.type != typeid(ChannelType)) return nullptr;
+
+        return std::static_pointer_cast<ChannelType>(iter->second.channel);
+    }
+}
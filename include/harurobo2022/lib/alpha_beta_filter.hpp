@@ -0,0 +1,99 @@
+/*
+
+α-βフィルタ。時刻つきの位置の観測から、位置と速度を推定する。Tはfloatでも、Vec2Dみたいなベクトルでもいい。
+
+観測が不定期に来ても、前の観測からの経過時間で予測してから補正するので大丈夫。
+position_at(t)で任意の時刻に外挿した位置が取れる。観測が途切れたときに速度で飛んでいかないよう、
+外挿はmax_extrapolation[s]までで止める。
+
+αは位置をどれだけ観測に寄せるか、βは速度をどれだけ直すか。0 < α <= 1、0 < β <= 2 - αくらいで使う。
+
+*/
+
+#pragma once
+
+#include <algorithm>
+
+namespace StewLib
+{
+    namespace
+    {
+        template<class T>
+        class AlphaBetaFilter final
+        {
+        public:
+            struct Parameter final
+            {
+                double alpha;
+                double beta;
+                double max_extrapolation;
+            };
+
+        private:
+            const Parameter param;
+
+            T position{};
+            T velocity{};
+            double last_time{0};
+            bool is_initialized{false};
+
+        public:
+            constexpr AlphaBetaFilter(const Parameter& param) noexcept:
+                param{param}
+            {}
+
+            // time[s]に観測したposition
+            void update(const T& measured, const double time) noexcept
+            {
+                if(!is_initialized)
+                {
+                    position = measured;
+                    velocity = T{};
+                    last_time = time;
+                    is_initialized = true;
+                    return;
+                }
+
+                const double dt = time - last_time;
+                // 同じ時刻か時刻が戻ったら、位置だけ観測に寄せる。
+                if(dt <= 0)
+                {
+                    position = position + param.alpha * (measured - position);
+                    return;
+                }
+
+                const T predicted = position + velocity * dt;
+                const T residual = measured - predicted;
+
+                position = predicted + param.alpha * residual;
+                velocity = velocity + (param.beta / dt) * residual;
+                last_time = time;
+            }
+
+            T position_at(const double time) const noexcept
+            {
+                if(!is_initialized) return position;
+
+                const double dt = std::clamp(time - last_time, 0.0, param.max_extrapolation);
+                return position + velocity * dt;
+            }
+
+            const T& get_velocity() const noexcept
+            {
+                return velocity;
+            }
+
+            bool has_measurement() const noexcept
+            {
+                return is_initialized;
+            }
+
+            // 次の観測からやり直す。
+            void reset() noexcept
+            {
+                velocity = T{};
+                is_initialized = false;
+            }
+        };
+    }
+}
@@ -0,0 +1,257 @@
+/*
+
+CANに載せるデータの並べ方(前はSerializeとReverseBufferでやっていた)。
+
+    byteswap(v)             バイト順を逆にする。1, 2, 4, 8バイトは__builtin_bswapで、それ以外は1バイトずつ。
+    BigEndian<T>            Tを上位バイトから並べて持つ(shirasuのtargetなど)。LittleEndian<T>はその逆。
+                            中身はただのバイト列なので、並べて構造体にしても隙間ができない(TwistのCanDataなど)。
+    CanFrameLayout<size>    sizeバイトを8バイトずつに分けたときのフレームの数と、それぞれのdlc。
+    CanFrames<Data>         Dataを上の通りに分けたもの。最後のフレームの余りは0で埋める。
+
+std::bit_castがあれば全部constexprで、下のstatic_assertで1~64バイトの全部の大きさを確かめる。
+なければ(NUCのg++-9など)memcpyで同じことをする。こちらはコンパイル時には確かめられないので、
+同じ確かめをtools/can_codec_checkが実行時にやる。HARUROBO2022_CAN_CODEC_NO_BIT_CASTを定義すると
+std::bit_castがあってもmemcpyの方を使う(can_codec_checkはこれでビルドする)。
+
+*/
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace StewLib
+{
+    namespace
+    {
+        namespace CanCodecImplement
+        {
+            template<class To, class From>
+            constexpr To bit_cast(const From& from) noexcept
+            {
+                static_assert(sizeof(To) == sizeof(From), "size must be same.");
+                static_assert(std::is_trivially_copyable_v<To> && std::is_trivially_copyable_v<From>, "must be trivially copyable.");
+
+#if defined(__cpp_lib_bit_cast) && !defined(HARUROBO2022_CAN_CODEC_NO_BIT_CAST)
+                return std::bit_cast<To>(from);
+#else
+                To to;
+                std::memcpy(static_cast<void *>(&to), &from, sizeof(To));
+                return to;
+#endif
+            }
+
+            template<std::size_t size>
+            struct Bytes final
+            {
+                std::uint8_t bytes[size];
+            };
+        }
+
+        template<class T>
+        constexpr T byteswap(const T& value) noexcept
+        {
+            using CanCodecImplement::bit_cast;
+
+            if constexpr(sizeof(T) == 1) return value;
+            else if constexpr(sizeof(T) == 2) return bit_cast<T>(__builtin_bswap16(bit_cast<std::uint16_t>(value)));
+            else if constexpr(sizeof(T) == 4) return bit_cast<T>(__builtin_bswap32(bit_cast<std::uint32_t>(value)));
+            else if constexpr(sizeof(T) == 8) return bit_cast<T>(__builtin_bswap64(bit_cast<std::uint64_t>(value)));
+            else
+            {
+                auto data = bit_cast<CanCodecImplement::Bytes<sizeof(T)>>(value);
+                for(std::size_t i = 0; i < sizeof(T) / 2; ++i)
+                {
+                    const std::uint8_t tmp = data.bytes[i];
+                    data.bytes[i] = data.bytes[sizeof(T) - 1 - i];
+                    data.bytes[sizeof(T) - 1 - i] = tmp;
+                }
+                return bit_cast<T>(data);
+            }
+        }
+
+        template<class T, std::endian order>
+        struct EndianBuffer final
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+            static_assert(std::endian::native == std::endian::little || std::endian::native == std::endian::big, "mixed endian is not supported.");
+
+            constexpr static std::size_t size = sizeof(T);
+            std::uint8_t bytes[size]{};
+
+            EndianBuffer() = default;
+
+            constexpr EndianBuffer(const T& value) noexcept:
+                EndianBuffer{CanCodecImplement::bit_cast<EndianBuffer>(order == std::endian::native ? value : byteswap(value))}
+            {}
+
+            constexpr operator T() const noexcept
+            {
+                const T value = CanCodecImplement::bit_cast<T>(*this);
+                return order == std::endian::native ? value : byteswap(value);
+            }
+        };
+
+        template<class T>
+        using BigEndian = EndianBuffer<T, std::endian::big>;
+
+        template<class T>
+        using LittleEndian = EndianBuffer<T, std::endian::little>;
+
+        template<std::size_t size_, std::size_t unit_size_ = 8>
+        struct CanFrameLayout final
+        {
+            static_assert(size_ > 0, "data must not be empty.");
+            static_assert(unit_size_ > 0, "unit size must not be 0.");
+
+            constexpr static std::size_t size = size_;
+            constexpr static std::size_t unit_size = unit_size_;
+            constexpr static std::size_t frame_count = (size + unit_size - 1) / unit_size;
+            constexpr static std::size_t last_size = size - unit_size * (frame_count - 1);
+
+            static constexpr std::uint8_t dlc(const std::size_t index) noexcept
+            {
+                return (index == frame_count - 1) ? last_size : unit_size;
+            }
+        };
+
+        template<class Data_, std::size_t unit_size_ = 8>
+        struct CanFrames final
+        {
+            using Data = Data_;
+            using Layout = CanFrameLayout<sizeof(Data), unit_size_>;
+
+            static_assert(std::is_trivially_copyable_v<Data>, "Data must be trivially copyable.");
+
+            std::uint8_t chunks[Layout::frame_count][Layout::unit_size]{};
+
+            constexpr CanFrames(const Data& data) noexcept
+            {
+                const auto data_bytes = CanCodecImplement::bit_cast<CanCodecImplement::Bytes<sizeof(Data)>>(data);
+                for(std::size_t i = 0; i < sizeof(Data); ++i)
+                {
+                    chunks[i / Layout::unit_size][i % Layout::unit_size] = data_bytes.bytes[i];
+                }
+            }
+
+            // 分ける前に戻す。
+            constexpr Data join() const noexcept
+            {
+                CanCodecImplement::Bytes<sizeof(Data)> data_bytes{};
+                for(std::size_t i = 0; i < sizeof(Data); ++i)
+                {
+                    data_bytes.bytes[i] = chunks[i / Layout::unit_size][i % Layout::unit_size];
+                }
+                return CanCodecImplement::bit_cast<Data>(data_bytes);
+            }
+        };
+
+        namespace CanCodecImplement
+        {
+            // 0, 1, 2, ...を詰めたsizeバイトを分けて、並びと長さと余りの0を確かめ、戻して同じになるか見る。
+            template<std::size_t size>
+            constexpr bool check_frames() noexcept
+            {
+                using Layout = CanFrameLayout<size>;
+
+                Bytes<size> data{};
+                for(std::size_t i = 0; i < size; ++i) data.bytes[i] = static_cast<std::uint8_t>(i + 1);
+
+                const CanFrames<Bytes<size>> frames{data};
+
+                std::size_t dlc_sum = 0;
+                for(std::size_t i = 0; i < Layout::frame_count; ++i)
+                {
+                    const std::uint8_t dlc = Layout::dlc(i);
+                    if(dlc == 0 || dlc > 8) return false;
+                    dlc_sum += dlc;
+
+                    for(std::size_t j = 0; j < 8; ++j)
+                    {
+                        const std::uint8_t expected = (j < dlc) ? static_cast<std::uint8_t>(8 * i + j + 1) : 0;
+                        if(frames.chunks[i][j] != expected) return false;
+                    }
+                }
+                if(dlc_sum != size) return false;
+
+                const Bytes<size> joined = frames.join();
+                for(std::size_t i = 0; i < size; ++i)
+                {
+                    if(joined.bytes[i] != data.bytes[i]) return false;
+                }
+
+                // 全部の大きさでbyteswapとBigEndianも確かめる。
+                const Bytes<size> swapped = byteswap(data);
+                for(std::size_t i = 0; i < size; ++i)
+                {
+                    if(swapped.bytes[i] != data.bytes[size - 1 - i]) return false;
+                }
+
+                const BigEndian<Bytes<size>> big{data};
+                for(std::size_t i = 0; i < size; ++i)
+                {
+                    if(big.bytes[i] != ((std::endian::native == std::endian::little) ? data.bytes[size - 1 - i] : data.bytes[i])) return false;
+                }
+                const Bytes<size> restored = big;
+                for(std::size_t i = 0; i < size; ++i)
+                {
+                    if(restored.bytes[i] != data.bytes[i]) return false;
+                }
+
+                return true;
+            }
+
+            template<std::size_t ... sizes>
+            constexpr bool check_all_frames(std::index_sequence<sizes ...>) noexcept
+            {
+                return (check_frames<sizes + 1>() && ...);
+            }
+
+            // 並べても隙間ができない。
+            struct Float3 final
+            {
+                BigEndian<float> x, y, z;
+            };
+
+            // 決まった値でbyteswapとBigEndian, LittleEndianを確かめる。
+            template<class Dummy = void>
+            constexpr bool check_values() noexcept
+            {
+                if(byteswap(std::uint16_t{0x0102}) != 0x0201) return false;
+                if(byteswap(std::uint32_t{0x01020304}) != 0x04030201) return false;
+                if(byteswap(std::uint64_t{0x0102030405060708}) != 0x0807060504030201) return false;
+                if(byteswap(byteswap(1.5f)) != 1.5f) return false;
+                if(byteswap(byteswap(-2.25)) != -2.25) return false;
+
+                // 1.0fは0x3F800000なので、上位バイトから0x3F, 0x80, 0, 0。
+                const BigEndian<float> big_one{1.0f};
+                if(big_one.bytes[0] != 0x3F || big_one.bytes[1] != 0x80 || big_one.bytes[2] || big_one.bytes[3]) return false;
+                const LittleEndian<float> little_one{1.0f};
+                if(little_one.bytes[3] != 0x3F || little_one.bytes[2] != 0x80 || little_one.bytes[1] || little_one.bytes[0]) return false;
+                if(static_cast<float>(BigEndian<float>{-3.5f}) != -3.5f) return false;
+
+                const CanFrames<Float3> frames{Float3{1.0f, 2.0f, -3.5f}};
+                const Float3 joined = frames.join();
+                return static_cast<float>(joined.x) == 1.0f && static_cast<float>(joined.y) == 2.0f && static_cast<float>(joined.z) == -3.5f;
+            }
+
+            // 大きさはbit_castに関係なく確かめられる。
+            static_assert(CanFrameLayout<1>::frame_count == 1 && CanFrameLayout<1>::last_size == 1);
+            static_assert(CanFrameLayout<8>::frame_count == 1 && CanFrameLayout<8>::last_size == 8);
+            static_assert(CanFrameLayout<9>::frame_count == 2 && CanFrameLayout<9>::last_size == 1);
+            static_assert(CanFrameLayout<12>::frame_count == 2 && CanFrameLayout<12>::last_size == 4);
+            static_assert(CanFrameLayout<64>::frame_count == 8 && CanFrameLayout<64>::last_size == 8);
+            static_assert(sizeof(Float3) == 12 && alignof(Float3) == 1);
+            static_assert(CanFrames<Float3>::Layout::frame_count == 2 && CanFrames<Float3>::Layout::dlc(1) == 4);
+
+#if defined(__cpp_lib_bit_cast) && !defined(HARUROBO2022_CAN_CODEC_NO_BIT_CAST)
+            static_assert(check_all_frames(std::make_index_sequence<64>()), "CanFrames is broken.");
+            static_assert(check_values(), "byteswap or EndianBuffer is broken.");
+#endif
+        }
+    }
+}
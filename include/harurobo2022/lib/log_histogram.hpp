@@ -0,0 +1,101 @@
+/*
+
+HDR Histogramっぽいもの。値を2のべきごとに区切り、その中をさらにsub_bucket_size個に等分して数える。
+相対誤差は1 / sub_bucket_sizeくらい。カウンタは全部アトミックなので、記録は複数スレッドからロックなしでできる。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+
+namespace StewLib
+{
+    namespace
+    {
+        template<std::size_t sub_bucket_bits = 4, std::size_t max_bits = 36>
+        class LogHistogram final
+        {
+        public:
+            constexpr static std::size_t sub_bucket_size = std::size_t(1) << sub_bucket_bits;
+            constexpr static std::size_t bucket_size = (max_bits - sub_bucket_bits + 1) * sub_bucket_size;
+            constexpr static std::uint64_t max_value = (std::uint64_t(1) << max_bits) - 1;
+
+            static_assert(max_bits < 64 && sub_bucket_bits < max_bits, "invalid bits.");
+
+        private:
+            std::atomic<std::uint64_t> buckets[bucket_size]{};
+            std::atomic<std::uint64_t> count_{0};
+            std::atomic<std::uint64_t> sum_{0};
+            std::atomic<std::uint64_t> max_{0};
+
+        public:
+            constexpr static std::size_t index_of(std::uint64_t value) noexcept
+            {
+                value = std::min(value, max_value);
+                if(value < sub_bucket_size) return value;
+
+                const std::size_t shift = 63 - __builtin_clzll(value) - sub_bucket_bits;
+                return (shift + 1) * sub_bucket_size + ((value >> shift) & (sub_bucket_size - 1));
+            }
+
+            // そのバケツに入る最小の値。
+            constexpr static std::uint64_t value_of(const std::size_t index) noexcept
+            {
+                if(index < sub_bucket_size) return index;
+
+                const std::size_t shift = index / sub_bucket_size - 1;
+                return (sub_bucket_size + index % sub_bucket_size) << shift;
+            }
+
+            void record(const std::uint64_t value) noexcept
+            {
+                buckets[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+                count_.fetch_add(1, std::memory_order_relaxed);
+                sum_.fetch_add(value, std::memory_order_relaxed);
+
+                std::uint64_t old_max = max_.load(std::memory_order_relaxed);
+                while(old_max < value && !max_.compare_exchange_weak(old_max, value, std::memory_order_relaxed));
+            }
+
+            std::uint64_t count() const noexcept
+            {
+                return count_.load(std::memory_order_relaxed);
+            }
+
+            double mean() const noexcept
+            {
+                const std::uint64_t n = count();
+                return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0;
+            }
+
+            std::uint64_t max() const noexcept
+            {
+                return max_.load(std::memory_order_relaxed);
+            }
+
+            // percentileは0~100。記録中に呼ばれてもだいたい正しい値を返す。
+            std::uint64_t percentile(const double percentile) const noexcept
+            {
+                const std::uint64_t n = count();
+                if(!n) return 0;
+
+                const std::uint64_t target = std::max<std::uint64_t>(1, percentile / 100 * n + 0.5);
+                std::uint64_t sum = 0;
+                for(std::size_t i = 0; i < bucket_size; ++i)
+                {
+                    sum += buckets[i].load(std::memory_order_relaxed);
+                    if(sum >= target) return std::min(value_of(i), max());
+                }
+
+                return max();
+            }
+        };
+
+        static_assert(LogHistogram<>::value_of(LogHistogram<>::index_of(1000)) == 992);
+        static_assert(LogHistogram<>::index_of(LogHistogram<>::max_value) == LogHistogram<>::bucket_size - 1);
+    }
+}
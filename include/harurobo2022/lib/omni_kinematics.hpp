@@ -0,0 +1,148 @@
+/*
+
+N輪のオムニ(メカナムでも)の運動学。
+各ホイールの位置と正転の向きから、機体速度->ホイール角速度の係数をコンパイル時に計算しておく。
+係数は成分ごとの配列(SoA)で持ち、SIMDでまとめて掛ける。ついでに絶対値の最大と前回からの差の絶対値の最大も同じ周回で取る。
+
+逆(ホイール角速度->機体速度)は、係数行列の擬似逆行列をこれもコンパイル時に作っておく。
+ホイールが3つ以上あって、全部が機体の中心を向いていたりしなければ求まる。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include "vec2d.hpp"
+#include "simd.hpp"
+
+namespace StewLib
+{
+    namespace
+    {
+        template<std::size_t N, class T = double>
+        class OmniKinematics final
+        {
+            static_assert(N >= 3, "omni wheel needs at least 3 wheels.");
+
+        public:
+            constexpr static std::size_t size = N;
+            constexpr static std::size_t padded_size = simd_round_up<T>(N);
+
+            struct Twist final
+            {
+                Vec2D<T> vell;
+                T vela;
+            };
+
+            struct Reduction final
+            {
+                T max_abs_vela;
+                T max_abs_diff;
+            };
+
+        private:
+            // ホイール半径で割ってある。詰め物の分は0。
+            T dir_x[padded_size]{};
+            T dir_y[padded_size]{};
+            T rot[padded_size]{};
+
+            T pinv[3][N]{};
+
+        public:
+            constexpr OmniKinematics(const Vec2D<double> (&pos)[N], const Vec2D<double> (&dir)[N], const double wheel_radius) noexcept
+            {
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    const auto unit_dir = ~dir[i];
+                    dir_x[i] = unit_dir.x / wheel_radius;
+                    dir_y[i] = unit_dir.y / wheel_radius;
+                    // 回転による速度は位置をπ/2回したものにノルムを掛けたもの。
+                    rot[i] = (!pos[i] * unit_dir) / wheel_radius;
+                }
+
+                // pinv = (A^T A)^-1 A^T。Aの各行は{dir_x, dir_y, rot}。
+                double m[3][3]{};
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    const double row[3] = {dir_x[i], dir_y[i], rot[i]};
+                    for(int r = 0; r < 3; ++r) for(int c = 0; c < 3; ++c) m[r][c] += row[r] * row[c];
+                }
+
+                const double det =
+                    m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                    m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                    m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+
+                const double inv[3][3] =
+                {
+                    {(m[1][1] * m[2][2] - m[1][2] * m[2][1]) / det, (m[0][2] * m[2][1] - m[0][1] * m[2][2]) / det, (m[0][1] * m[1][2] - m[0][2] * m[1][1]) / det},
+                    {(m[1][2] * m[2][0] - m[1][0] * m[2][2]) / det, (m[0][0] * m[2][2] - m[0][2] * m[2][0]) / det, (m[0][2] * m[1][0] - m[0][0] * m[1][2]) / det},
+                    {(m[1][0] * m[2][1] - m[1][1] * m[2][0]) / det, (m[0][1] * m[2][0] - m[0][0] * m[2][1]) / det, (m[0][0] * m[1][1] - m[0][1] * m[1][0]) / det}
+                };
+
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    const double row[3] = {dir_x[i], dir_y[i], rot[i]};
+                    for(int r = 0; r < 3; ++r)
+                    {
+                        pinv[r][i] = inv[r][0] * row[0] + inv[r][1] * row[1] + inv[r][2] * row[2];
+                    }
+                }
+            }
+
+            // 機体速度からホイール角速度を求める。pre_wheels_velaとの差の最大も返す。
+            Reduction inverse(const Vec2D<T>& body_vell, const T body_vela, const T (&pre_wheels_vela)[N], T (&wheels_vela)[N]) const noexcept
+            {
+                constexpr std::size_t lanes = simd_lanes<T>;
+
+                T pre[padded_size]{};
+                T out[padded_size];
+                std::memcpy(pre, pre_wheels_vela, sizeof(pre_wheels_vela));
+
+                const auto vx = simd_broadcast<T>(body_vell.x);
+                const auto vy = simd_broadcast<T>(body_vell.y);
+                const auto w = simd_broadcast<T>(body_vela);
+
+                auto max_abs_vela = simd_broadcast<T>(0);
+                auto max_abs_diff = simd_broadcast<T>(0);
+
+                for(std::size_t i = 0; i < padded_size; i += lanes)
+                {
+                    const auto v = simd_load(dir_x + i) * vx + simd_load(dir_y + i) * vy + simd_load(rot + i) * w;
+                    simd_store(out + i, v);
+
+                    max_abs_vela = simd_max(max_abs_vela, simd_abs(v));
+                    max_abs_diff = simd_max(max_abs_diff, simd_abs(v - simd_load(pre + i)));
+                }
+
+                std::memcpy(wheels_vela, out, sizeof(wheels_vela));
+
+                return {simd_hmax(max_abs_vela), simd_hmax(max_abs_diff)};
+            }
+
+            // 差がいらないとき。絶対値の最大を返す。
+            T inverse(const Vec2D<T>& body_vell, const T body_vela, T (&wheels_vela)[N]) const noexcept
+            {
+                constexpr T zeros[N]{};
+                return inverse(body_vell, body_vela, zeros, wheels_vela).max_abs_vela;
+            }
+
+            // ホイール角速度から機体速度を求める(最小二乗)。
+            constexpr Twist forward(const T (&wheels_vela)[N]) const noexcept
+            {
+                T ret[3]{};
+                for(int r = 0; r < 3; ++r)
+                {
+                    for(std::size_t i = 0; i < N; ++i)
+                    {
+                        ret[r] += pinv[r][i] * wheels_vela[i];
+                    }
+                }
+
+                return {{ret[0], ret[1]}, ret[2]};
+            }
+        };
+    }
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <type_traits>
+
 namespace StewLib
 {
     namespace
@@ -17,10 +20,99 @@ namespace StewLib
             T operator()(const T& dev) noexcept
             {
                 sum_dev += dev;
+                const T diff_dev = dev - last_dev;
                 last_dev = dev;
 
-                return k_p * dev + k_i * sum_dev + k_d * last_dev;
+                return k_p * dev + k_i * sum_dev + k_d * diff_dev;
+            }
+        };
+
+        /*
+        周期dtで呼ぶ前提のPID。Tはfloatみたいなスカラーでも、Vec2Dみたいなベクトルでもいい。
+
+        出力(フィードフォワード込み)はノルムがoutput_limitを超えないように縮める。
+        縮めたときに偏差がさらに外へ押す向きなら積分を止める(条件付き積分)ので、長く張り付いても積分が溜まらない。
+        微分は偏差の差分を時定数derivative_tauの一次遅れに通してから使う。0なら素通し。
+        */
+        template<class T>
+        class DiscretePid final
+        {
+        public:
+            struct Parameter final
+            {
+                double k_p;
+                double k_i;
+                double k_d;
+                double dt;
+                double derivative_tau{0};
+                double output_limit{0};  // 0なら制限しない
+            };
+
+        private:
+            const Parameter param;
+
+            T integral{};
+            T derivative{};
+            T last_dev{};
+            bool has_last_dev{false};
+
+            static double magnitude(const T& x) noexcept
+            {
+                if constexpr(std::is_arithmetic_v<T>) return std::abs(x);
+                else return +x;
+            }
+
+        public:
+            constexpr DiscretePid(const Parameter& param) noexcept:
+                param{param}
+            {}
+
+            T operator()(const T& dev, const T& feedforward = T{}) noexcept
+            {
+                // 最初の一回は差分が取れないので微分は0のまま。
+                if(has_last_dev)
+                {
+                    const double alpha = param.dt / (param.derivative_tau + param.dt);
+                    derivative = derivative + alpha * ((dev - last_dev) / param.dt - derivative);
+                }
+                last_dev = dev;
+                has_last_dev = true;
+
+                const T next_integral = integral + dev * param.dt;
+                T output = feedforward + param.k_p * dev + param.k_i * next_integral + param.k_d * derivative;
+
+                const double norm = magnitude(output);
+                if(!param.output_limit || norm <= param.output_limit)
+                {
+                    integral = next_integral;
+                    return output;
+                }
+
+                // 張り付いている。積分で内側に戻れるときだけ積分する。(Vec2D同士の*は内積)
+                if(param.k_i * (output * dev) < 0)
+                {
+                    integral = next_integral;
+                }
+                else
+                {
+                    output = feedforward + param.k_p * dev + param.k_i * integral + param.k_d * derivative;
+                }
+
+                if(const double new_norm = magnitude(output); new_norm > param.output_limit)
+                {
+                    output = output * (param.output_limit / new_norm);
+                }
+
+                return output;
+            }
+
+            void reset() noexcept
+            {
+                integral = T{};
+                derivative = T{};
+                last_dev = T{};
+                has_last_dev = false;
             }
         };
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,196 @@
+/*
+
+N個の値をまとめて制限する。速度、加速度、加加速度の順に、絶対値の最大が上限を超えたら全部を同じ比で縮める。
+速度と加速度の制限は比を保つので、ホイール速度に使えば機体の進む向きと回転の比は変わらない。
+
+加加速度の制限は前の周期の加速度から始めるので、加速度の向きが変わる途中では比は保たれない(落ち着けば戻る)。
+目標に着いたときに加速度がちょうど0になるよう、加加速度の上限で0まで戻して目標に届く加速度(目標までの残りで決まる)を
+各々の上限にする。なので目標が変わらなければ、目標を越えずに加速度0で着く。
+加加速度の上限は必ず守る。途中で目標が手前に変わると、0まで戻しきるぶんだけ新しい目標を越えてから戻ってくる
+(それでも前の目標の手前で止まるので、速度の上限は越えない)。
+
+上限は全部「1秒あたり」で、dtで1周期あたりに直す。0にするとその制限はかからない。
+制限がかかった回数を数えておくので、周期の外から見て報告すること。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+namespace StewLib
+{
+    namespace
+    {
+        template<std::size_t N, class T = double>
+        class RateLimiter final
+        {
+        public:
+            struct Limit final
+            {
+                T vel;
+                T acc;
+                T jerk;
+            };
+
+            struct SaturationCount final
+            {
+                std::uint64_t vel{0};
+                std::uint64_t acc{0};
+                std::uint64_t jerk{0};
+            };
+
+        private:
+            const Limit limit;
+            const T dt;
+
+            T pre_vel[N]{};
+            T pre_acc[N]{};
+
+            SaturationCount saturation_count{};
+
+            static T max_abs(const T (&values)[N]) noexcept
+            {
+                T max = 0;
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    if(max < std::abs(values[i])) max = std::abs(values[i]);
+                }
+                return max;
+            }
+
+        public:
+            constexpr RateLimiter(const Limit& limit, const T dt) noexcept:
+                limit{limit},
+                dt{dt}
+            {}
+
+            // velを制限した値で書き換える。max_abs_velが分かっていれば渡すと一周減る。
+            void operator()(T (&vel)[N], T max_abs_vel = -1) noexcept
+            {
+                if(max_abs_vel < 0) max_abs_vel = max_abs(vel);
+
+                if(limit.vel && max_abs_vel > limit.vel)
+                {
+                    ++saturation_count.vel;
+                    const T factor = limit.vel / max_abs_vel;
+                    for(std::size_t i = 0; i < N; ++i) vel[i] *= factor;
+                }
+
+                T acc[N];
+                for(std::size_t i = 0; i < N; ++i) acc[i] = (vel[i] - pre_vel[i]) / dt;
+
+                if(limit.acc)
+                {
+                    const T max_abs_acc = max_abs(acc);
+                    if(max_abs_acc > limit.acc)
+                    {
+                        ++saturation_count.acc;
+                        const T factor = limit.acc / max_abs_acc;
+                        for(std::size_t i = 0; i < N; ++i) acc[i] *= factor;
+                    }
+                }
+
+                if(limit.jerk)
+                {
+                    limit_jerk(vel, acc);
+                }
+                else
+                {
+                    for(std::size_t i = 0; i < N; ++i) vel[i] = pre_vel[i] + acc[i] * dt;
+                }
+
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    pre_vel[i] = vel[i];
+                    pre_acc[i] = acc[i];
+                }
+            }
+
+        private:
+            // targetはもう速度と加速度の制限をかけた目標。accは目標へ向かう加速度で、制限をかけた値で書き換える。
+            void limit_jerk(T (&target)[N], T (&acc)[N]) noexcept
+            {
+                for(std::size_t i = 0; i < N; ++i) clamp_to_stoppable(i, target[i], acc[i], false);
+
+                T jerk[N];
+                for(std::size_t i = 0; i < N; ++i) jerk[i] = (acc[i] - pre_acc[i]) / dt;
+
+                const T max_abs_jerk = max_abs(jerk);
+                if(max_abs_jerk > limit.jerk)
+                {
+                    ++saturation_count.jerk;
+                    const T factor = limit.jerk / max_abs_jerk;
+                    for(std::size_t i = 0; i < N; ++i) acc[i] = pre_acc[i] + jerk[i] * factor * dt;
+                }
+
+                // 同じ比で縮めると、止まり始めないといけないものまで減らし方が足りなくなることがあるので、各々もう一度絞る。
+                // ただし前の周期から加加速度の上限より大きくは変えない。
+                for(std::size_t i = 0; i < N; ++i) clamp_to_stoppable(i, target[i], acc[i], true);
+
+                T vel[N];
+                for(std::size_t i = 0; i < N; ++i) vel[i] = pre_vel[i] + acc[i] * dt;
+
+                // 上の通りなら越えないはずだが、念のため。
+                if(limit.vel)
+                {
+                    const T max_abs_vel = max_abs(vel);
+                    if(max_abs_vel > limit.vel)
+                    {
+                        ++saturation_count.vel;
+                        const T factor = limit.vel / max_abs_vel;
+                        for(std::size_t i = 0; i < N; ++i) vel[i] *= factor;
+                    }
+                }
+
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    acc[i] = (vel[i] - pre_vel[i]) / dt;
+                    target[i] = vel[i];
+                }
+            }
+
+            // 加加速度の上限で加速度を0まで戻しながら目標に届く加速度までaccを絞る。
+            // 加速度aから1周期ごとにs = J dtずつ減らすと、0になるまでに速度は
+            //     F(a) = dt (a + (a - s) + ... + (a - m s)) = dt ((m + 1) a - s m (m + 1) / 2)   (m = floor(a / s))
+            // だけ進む。F(a) <= 残り となる一番大きいaが上限。F(m s) = dt s m (m + 1) / 2 からmを決めて、その区間の一次式を解く。
+            // F(a) = a dt + F(a - s) なので、この上限を守っていれば次の周期もa - sは上限の内側にある(目標が変わらなければ)。
+            // keep_jerkなら前の周期の加速度から加加速度の上限より大きくは変えない(目標が手前に変わったとき)。
+            void clamp_to_stoppable(const std::size_t i, const T target, T& acc, const bool keep_jerk) const noexcept
+            {
+                const T jerk_step = limit.jerk * dt;
+                const T rest = target - pre_vel[i];
+                const T q = 2 * std::abs(rest) / (jerk_step * dt);
+                const T m = std::floor((std::sqrt(1 + 4 * q) - 1) / 2);
+                const T stoppable = (std::abs(rest) / dt + jerk_step * m * (m + 1) / 2) / (m + 1);
+
+                if(rest >= 0 && acc > stoppable)
+                {
+                    acc = (keep_jerk && stoppable < pre_acc[i] - jerk_step) ? pre_acc[i] - jerk_step : stoppable;
+                }
+                else if(rest <= 0 && acc < -stoppable)
+                {
+                    acc = (keep_jerk && -stoppable > pre_acc[i] + jerk_step) ? pre_acc[i] + jerk_step : -stoppable;
+                }
+            }
+
+        public:
+            // 止まっている状態からやり直す。
+            void reset() noexcept
+            {
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    pre_vel[i] = 0;
+                    pre_acc[i] = 0;
+                }
+            }
+
+            const SaturationCount& get_saturation_count() const noexcept
+            {
+                return saturation_count;
+            }
+        };
+    }
+}
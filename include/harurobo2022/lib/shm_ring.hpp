@@ -0,0 +1,311 @@
+/*
+
+POSIXの共有メモリに置く固定長のリングバッファ。複数プロセスから書いて一つのプロセスが読む。
+Dmitry Vyukov氏のbounded MPMC queueそのまま。各セルに通し番号を持たせてロックなしで回す。
+
+中身はプロセスを跨いでmemcpyされるので、Tはトリビアルにコピー可能であること。
+std::atomicはロックフリーならアドレスに依存しないので共有メモリに置いても大丈夫...なはず。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace StewLib
+{
+    namespace
+    {
+        inline std::uint64_t monotonic_ns() noexcept
+        {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+        }
+
+        template<class T, std::size_t capacity_>
+        class ShmRing final
+        {
+        public:
+            constexpr static std::size_t capacity = capacity_;
+
+            static_assert(capacity >= 2 && !(capacity & (capacity - 1)), "capacity must be power of 2.");
+            static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+            static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "std::atomic<std::uint64_t> must be lock free.");
+
+        private:
+            // 型とサイズが食い違ったリングを開かないように。
+            constexpr static std::uint64_t magic = 0x5374'6577'0000'0000 ^ (sizeof(T) << 24) ^ capacity;
+
+            struct Cell final
+            {
+                std::atomic<std::uint64_t> sequence;
+                T data;
+            };
+
+            struct Shared final
+            {
+                std::atomic<std::uint64_t> magic;
+                std::atomic<std::uint64_t> consumer_heartbeat_ns;
+                alignas(64) std::atomic<std::uint64_t> enqueue_pos;
+                alignas(64) std::atomic<std::uint64_t> dequeue_pos;
+                alignas(64) Cell cells[capacity];
+            };
+
+            Shared * shared{nullptr};
+            const char * name{nullptr};
+            bool is_owner{false};
+
+            ShmRing(Shared *const shared, const char *const name, const bool is_owner) noexcept:
+                shared{shared},
+                name{name},
+                is_owner{is_owner}
+            {}
+
+        public:
+            ShmRing() = default;
+            ShmRing(const ShmRing&) = delete;
+            ShmRing& operator=(const ShmRing&) = delete;
+
+            ShmRing(ShmRing&& obj) noexcept:
+                shared{obj.shared},
+                name{obj.name},
+                is_owner{obj.is_owner}
+            {
+                obj.shared = nullptr;
+            }
+
+            ShmRing& operator=(ShmRing&& obj) noexcept
+            {
+                if(this != &obj)
+                {
+                    close();
+                    shared = obj.shared;
+                    name = obj.name;
+                    is_owner = obj.is_owner;
+                    obj.shared = nullptr;
+                }
+                return *this;
+            }
+
+            ~ShmRing() noexcept
+            {
+                close();
+            }
+
+            // 読む側が作る。前回のものが残っていても作り直す。
+            static ShmRing create(const char *const name) noexcept
+            {
+                shm_unlink(name);
+                const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+                if(fd < 0) return {};
+
+                if(ftruncate(fd, sizeof(Shared)) < 0)
+                {
+                    ::close(fd);
+                    shm_unlink(name);
+                    return {};
+                }
+
+                void *const p = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if(p == MAP_FAILED)
+                {
+                    shm_unlink(name);
+                    return {};
+                }
+
+                Shared *const shared = static_cast<Shared *>(p);
+                new(&shared->consumer_heartbeat_ns) std::atomic<std::uint64_t>{monotonic_ns()};
+                new(&shared->enqueue_pos) std::atomic<std::uint64_t>{0};
+                new(&shared->dequeue_pos) std::atomic<std::uint64_t>{0};
+                for(std::size_t i = 0; i < capacity; ++i)
+                {
+                    new(&shared->cells[i].sequence) std::atomic<std::uint64_t>{i};
+                }
+                new(&shared->magic) std::atomic<std::uint64_t>{};
+                shared->magic.store(magic, std::memory_order_release);
+
+                return {shared, name, true};
+            }
+
+            // 書く側が開く。まだ作られていなければ閉じたままのものが返る。
+            static ShmRing open(const char *const name) noexcept
+            {
+                const int fd = shm_open(name, O_RDWR, 0600);
+                if(fd < 0) return {};
+
+                struct stat st;
+                if(fstat(fd, &st) < 0 || static_cast<std::size_t>(st.st_size) != sizeof(Shared))
+                {
+                    ::close(fd);
+                    return {};
+                }
+
+                void *const p = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if(p == MAP_FAILED) return {};
+
+                Shared *const shared = static_cast<Shared *>(p);
+                if(shared->magic.load(std::memory_order_acquire) != magic)
+                {
+                    munmap(p, sizeof(Shared));
+                    return {};
+                }
+
+                return {shared, name, false};
+            }
+
+            void close() noexcept
+            {
+                if(!shared) return;
+
+                munmap(shared, sizeof(Shared));
+                if(is_owner) shm_unlink(name);
+                shared = nullptr;
+            }
+
+            bool is_open() const noexcept
+            {
+                return shared;
+            }
+
+            bool try_push(const T& data) noexcept
+            {
+                std::uint64_t pos = shared->enqueue_pos.load(std::memory_order_relaxed);
+
+                while(true)
+                {
+                    Cell& cell = shared->cells[pos & (capacity - 1)];
+                    const std::uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+                    const std::int64_t dif = static_cast<std::int64_t>(seq) - static_cast<std::int64_t>(pos);
+
+                    if(dif == 0)
+                    {
+                        if(shared->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            cell.data = data;
+                            cell.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if(dif < 0)
+                    {
+                        return false;  // 満杯
+                    }
+                    else
+                    {
+                        pos = shared->enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // count個をまとめて続きの場所に積む。全部入らなければ一つも積まずにfalse。
+            // 他の書き手のものと混ざらないので、分けて送るデータの途中で道が変わったりしない。get(i)でi番目を返すこと。
+            template<class F>
+            bool try_push_all(const std::size_t count, const F& get) noexcept
+            {
+                if(count > capacity) return false;
+                if(!count) return true;
+
+                std::uint64_t pos = shared->enqueue_pos.load(std::memory_order_relaxed);
+
+                while(true)
+                {
+                    bool is_free = true;
+                    bool is_stale = false;
+
+                    for(std::size_t i = 0; i < count; ++i)
+                    {
+                        const Cell& cell = shared->cells[(pos + i) & (capacity - 1)];
+                        const std::int64_t dif = static_cast<std::int64_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<std::int64_t>(pos + i);
+
+                        if(dif < 0)
+                        {
+                            is_free = false;
+                            break;
+                        }
+                        else if(dif > 0)
+                        {
+                            is_stale = true;
+                            break;
+                        }
+                    }
+
+                    if(!is_free) return false;  // 満杯
+
+                    if(is_stale)
+                    {
+                        pos = shared->enqueue_pos.load(std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    // 空きを確かめたセルは、enqueue_posを取れれば他の誰にも触られない。
+                    if(shared->enqueue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+                    {
+                        for(std::size_t i = 0; i < count; ++i)
+                        {
+                            Cell& cell = shared->cells[(pos + i) & (capacity - 1)];
+                            cell.data = get(i);
+                            cell.sequence.store(pos + i + 1, std::memory_order_release);
+                        }
+                        return true;
+                    }
+                }
+            }
+
+            bool try_pop(T& data) noexcept
+            {
+                std::uint64_t pos = shared->dequeue_pos.load(std::memory_order_relaxed);
+
+                while(true)
+                {
+                    Cell& cell = shared->cells[pos & (capacity - 1)];
+                    const std::uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+                    const std::int64_t dif = static_cast<std::int64_t>(seq) - static_cast<std::int64_t>(pos + 1);
+
+                    if(dif == 0)
+                    {
+                        if(shared->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            data = cell.data;
+                            cell.sequence.store(pos + capacity, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if(dif < 0)
+                    {
+                        return false;  // 空
+                    }
+                    else
+                    {
+                        pos = shared->dequeue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // 読む側が生きていることを知らせる。書く側はこれが古ければリングを使わない。書いた時刻を返す。
+            std::uint64_t beat() noexcept
+            {
+                const std::uint64_t now_ns = monotonic_ns();
+                shared->consumer_heartbeat_ns.store(now_ns, std::memory_order_relaxed);
+                return now_ns;
+            }
+
+            bool is_consumer_alive(const std::uint64_t now_ns, const std::uint64_t timeout_ns) const noexcept
+            {
+                return now_ns - shared->consumer_heartbeat_ns.load(std::memory_order_relaxed) < timeout_ns;
+            }
+        };
+    }
+}
@@ -0,0 +1,93 @@
+/*
+
+GCCのベクトル拡張を薄く包んだもの。幅はAVXが使えれば32バイト、なければ16バイト(SSE2)。
+x86以外でもGCCがスカラーに展開してくれるので動くはず。
+
+関数の引数や戻り値でベクトルを値渡しするとABIの警告が出る幅があるので、全部inlineで使うこと。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+namespace StewLib
+{
+    namespace
+    {
+        namespace SimdImplement
+        {
+#ifdef __AVX__
+            inline constexpr std::size_t width = 32;
+#else
+            inline constexpr std::size_t width = 16;
+#endif
+
+            template<class T>
+            struct Vector final
+            {
+                using type [[gnu::vector_size(width)]] = T;
+            };
+        }
+
+        template<class T>
+        inline constexpr std::size_t simd_lanes = SimdImplement::width / sizeof(T);
+
+        template<class T>
+        using SimdVec = typename SimdImplement::Vector<T>::type;
+
+        // 要素数をsimd_lanesの倍数に切り上げる。
+        template<class T>
+        constexpr std::size_t simd_round_up(const std::size_t n) noexcept
+        {
+            return (n + simd_lanes<T> - 1) / simd_lanes<T> * simd_lanes<T>;
+        }
+
+        template<class T>
+        inline SimdVec<T> simd_load(const T *const p) noexcept
+        {
+            SimdVec<T> v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        template<class T>
+        inline void simd_store(T *const p, const SimdVec<T>& v) noexcept
+        {
+            std::memcpy(p, &v, sizeof(v));
+        }
+
+        template<class T>
+        inline SimdVec<T> simd_broadcast(const T x) noexcept
+        {
+            return SimdVec<T>{} + x;
+        }
+
+        // SimdVec<T>からTは推論できないので、以下はベクトルの型そのものを受け取る。
+        template<class V>
+        inline V simd_abs(const V& v) noexcept
+        {
+            return v < 0 ? -v : v;
+        }
+
+        template<class V>
+        inline V simd_max(const V& a, const V& b) noexcept
+        {
+            return a > b ? a : b;
+        }
+
+        template<class V>
+        inline auto simd_hmax(const V& v) noexcept
+        {
+            constexpr std::size_t lanes = sizeof(V) / sizeof(v[0]);
+
+            auto ret = v[0];
+            for(std::size_t i = 1; i < lanes; ++i)
+            {
+                if(ret < v[i]) ret = v[i];
+            }
+            return ret;
+        }
+    }
+}
@@ -0,0 +1,189 @@
+/*
+
+折れ線の経路に台形の速度分布をつけたもの。経路は一度だけ計算しておき、時刻を渡すと目標位置と目標速度が返る。
+
+各頂点(通過点)では止まらない。頂点を通る速さは、その点の通過円の半径rで決める。
+追従をP制御(ゲインk_p)でやると、目標は速さvのときv / k_pくらい遅れてついてくる。
+角で向きがθ変わると、その遅れのベクトルが2 v sin(θ/2) / k_pだけずれるので、これがrに収まるよう
+    v <= r k_p / (2 sin(θ/2)) = r k_p / |u_前 - u_後|
+とする(uは各区間の向きの単位ベクトル)。ロボットは角の内側を丸く回る。
+そのあと、前から(加速できるか)と後ろから(止まれるか)一回ずつ頂点の速さを削って、各区間を台形にする。
+
+sampleは時刻が増える向きにだけ呼ぶこと。区間を指す位置を覚えておくので一回あたりO(1)。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "vec2d.hpp"
+
+namespace StewLib
+{
+    namespace
+    {
+        class TrapezoidalPath final
+        {
+        public:
+            struct Waypoint final
+            {
+                Vec2D<double> pos;
+                double range;  // 通過円の半径
+            };
+
+            struct Sample final
+            {
+                Vec2D<double> pos;
+                Vec2D<double> vel;
+                bool is_finished;
+            };
+
+        private:
+            struct Segment final
+            {
+                Vec2D<double> start;
+                Vec2D<double> dir;
+                double length;
+
+                double v_start;
+                double v_peak;
+                double v_end;
+
+                double t_begin;
+                double t_acc;
+                double t_cruise;
+                double t_dec;
+
+                double d_acc;
+                double d_cruise;
+            };
+
+            std::vector<Segment> segments{};
+            Vec2D<double> goal{0, 0};
+            double acc{1};
+            double total_time{0};
+            std::size_t cursor{0};
+
+        public:
+            // startから順にwaypointsを通ってwaypoints.back()で止まる。
+            void plan(const Vec2D<double>& start, const std::vector<Waypoint>& waypoints, const double vel_max, const double acc_max, const double k_p) noexcept
+            {
+                segments.clear();
+                cursor = 0;
+                total_time = 0;
+                acc = acc_max;
+                goal = start;
+
+                std::vector<double> ranges;
+
+                // 長さ0の区間は飛ばす。
+                Vec2D<double> last = start;
+                for(const auto& waypoint : waypoints)
+                {
+                    const auto diff = waypoint.pos - last;
+                    const double length = +diff;
+                    if(length < 1e-9) continue;
+
+                    segments.push_back({last, diff / length, length, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+                    ranges.push_back(waypoint.range);
+                    last = waypoint.pos;
+                }
+                goal = last;
+
+                if(segments.empty()) return;
+
+                // 頂点iは区間i-1の終わりで区間iの始まり。最初と最後は止まる。
+                const std::size_t n = segments.size();
+                std::vector<double> v(n + 1, 0);
+                for(std::size_t i = 1; i < n; ++i)
+                {
+                    const double turn = +(segments[i].dir - segments[i - 1].dir);
+                    v[i] = (turn > 1e-9) ? std::min(vel_max, ranges[i - 1] * k_p / turn) : vel_max;
+                }
+
+                for(std::size_t i = 1; i <= n; ++i)
+                {
+                    v[i] = std::min(v[i], std::sqrt(v[i - 1] * v[i - 1] + 2 * acc_max * segments[i - 1].length));
+                }
+                for(std::size_t i = n; i-- > 0;)
+                {
+                    v[i] = std::min(v[i], std::sqrt(v[i + 1] * v[i + 1] + 2 * acc_max * segments[i].length));
+                }
+
+                double t = 0;
+                for(std::size_t i = 0; i < n; ++i)
+                {
+                    Segment& segment = segments[i];
+                    const double v0 = v[i];
+                    const double v1 = v[i + 1];
+
+                    const double v_peak = std::min(vel_max, std::sqrt((2 * acc_max * segment.length + v0 * v0 + v1 * v1) / 2));
+                    const double d_acc = (v_peak * v_peak - v0 * v0) / (2 * acc_max);
+                    const double d_dec = (v_peak * v_peak - v1 * v1) / (2 * acc_max);
+                    const double d_cruise = std::max(0.0, segment.length - d_acc - d_dec);
+
+                    segment.v_start = v0;
+                    segment.v_peak = v_peak;
+                    segment.v_end = v1;
+                    segment.t_begin = t;
+                    segment.t_acc = (v_peak - v0) / acc_max;
+                    segment.t_cruise = (v_peak > 0) ? d_cruise / v_peak : 0;
+                    segment.t_dec = (v_peak - v1) / acc_max;
+                    segment.d_acc = d_acc;
+                    segment.d_cruise = d_cruise;
+
+                    t += segment.t_acc + segment.t_cruise + segment.t_dec;
+                }
+
+                total_time = t;
+            }
+
+            // 最初からやり直す。
+            void rewind() noexcept
+            {
+                cursor = 0;
+            }
+
+            double get_total_time() const noexcept
+            {
+                return total_time;
+            }
+
+            Sample sample(const double t) noexcept
+            {
+                if(segments.empty() || t >= total_time) return {goal, {0, 0}, true};
+
+                while(cursor + 1 < segments.size() && t >= segments[cursor + 1].t_begin) ++cursor;
+
+                const Segment& segment = segments[cursor];
+                const double tau = std::max(0.0, t - segment.t_begin);
+
+                double s, vel;
+                if(tau < segment.t_acc)
+                {
+                    s = segment.v_start * tau + acc * tau * tau / 2;
+                    vel = segment.v_start + acc * tau;
+                }
+                else if(tau < segment.t_acc + segment.t_cruise)
+                {
+                    s = segment.d_acc + segment.v_peak * (tau - segment.t_acc);
+                    vel = segment.v_peak;
+                }
+                else
+                {
+                    const double tau_dec = std::min(tau - segment.t_acc - segment.t_cruise, segment.t_dec);
+                    s = segment.d_acc + segment.d_cruise + segment.v_peak * tau_dec - acc * tau_dec * tau_dec / 2;
+                    vel = segment.v_peak - acc * tau_dec;
+                }
+
+                s = std::min(s, segment.length);
+
+                return {segment.start + s * segment.dir, vel * segment.dir, false};
+            }
+        };
+    }
+}
@@ -25,6 +25,9 @@ namespace Harurobo2022
             bool is_error{false};
             std::uint8_t dlc{};
             std::uint8_t data[8]{};
+            // header。ros::Timeはconstexprにできないのでナノ秒で持つ。0なら入れない。
+            std::uint32_t seq{};
+            std::uint64_t stamp_ns{};
 
             MessageConvertor() = default;
             MessageConvertor(const MessageConvertor&) = default;
@@ -41,14 +44,23 @@ namespace Harurobo2022
                 MessageConvertor(id, is_rtr, is_extended, is_error, dlc, data, StewLib::EnumerateMake<8>::type())
             {}
 
-            constexpr MessageConvertor(const Message& data) noexcept:
+            MessageConvertor(const Message& data) noexcept:
                 MessageConvertor(data.id, data.is_rtr, data.is_extended, data.is_error, data.dlc, data.data.elems, StewLib::EnumerateMake<8>::type())
-            {}
+            {
+                seq = data.header.seq;
+                stamp_ns = data.header.stamp.toNSec();
+            }
 
             operator Message() const noexcept
             {
                 Message msg;
 
+                if(stamp_ns)
+                {
+                    msg.header.seq = seq;
+                    msg.header.stamp.fromNSec(stamp_ns);
+                }
+
                 msg.id = id;
                 msg.is_rtr = is_rtr;
                 msg.is_extended = is_extended;
@@ -1,81 +1,76 @@
-// #pragma once
-
-// #include <cstring>
-
-// #include "harurobo2022/Odometry.h"
-
-// #include "../../lib/reverse_buffer.hpp"
-// #include "../template.hpp"
-
-
-// namespace Harurobo2022
-// {
-//     namespace
-//     {
-//         template<>
-//         struct MessageConvertor<harurobo2022::Odometry>
-//         {
-//             using Message = harurobo2022::Odometry;
-
-//             struct alignas(1) RawData final
-//             {
-//                 float pos_x{};
-//                 float pos_y{};
-//                 float rot_z{};
-//             };
-
-//             struct alignas(1) CanData final
-//             {
-//                 StewLib::ReverseBuffer<float> pos_x{};
-//                 StewLib::ReverseBuffer<float> pos_y{};
-//                 StewLib::ReverseBuffer<float> rot_z{};
-
-//                 void reverse() noexcept
-//                 {
-//                     pos_x.reverse();
-//                     pos_y.reverse();
-//                     rot_z.reverse();
-//                 }
-//             };
-
-//             RawData raw_data;
-
-//             MessageConvertor() = default;
-//             MessageConvertor(const MessageConvertor&) = default;
-//             MessageConvertor(MessageConvertor&&) = default;
-//             MessageConvertor& operator=(const MessageConvertor&) = default;
-//             MessageConvertor& operator=(MessageConvertor&&) = default;
-//             ~MessageConvertor() = default;
-
-//             constexpr MessageConvertor(const Message& msg) noexcept:
-//                 MessageConvertor(RawData{msg.pos_x, msg.pos_y, msg.rot_z})
-//             {}
-
-//             constexpr MessageConvertor(const RawData& raw_data) noexcept:
-//                 raw_data{raw_data}
-//             {}
-
-//             operator Message() const noexcept
-//             {
-//                 Message msg;
-//                 msg.pos_x = raw_data.pos_x;
-//                 msg.pos_y = raw_data.pos_y;
-//                 msg.rot_z = raw_data.rot_z;
-
-//                 return msg;
-//             }
-
-//             operator RawData() const noexcept
-//             {
-//                 return raw_data;
-//             }
-
-//             operator CanData() const noexcept
-//             {
-//                 CanData ret{raw_data.pos_x, raw_data.pos_y, raw_data.rot_z};
-//                 ret.reverse();
-//                 return ret;
-//             }
-//         };
-//     }
-// }
\ No newline at end of file
+#pragma once
+
+#include <cstring>
+
+#include "harurobo2022/Odometry.h"
+
+#include "../../lib/can_codec.hpp"
+#include "../template.hpp"
+
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        // x, y, yawを1サンプルとしてまとめて扱う。stampはそのサンプルを受け取った時刻。
+        template<>
+        struct MessageConvertor<harurobo2022::Odometry>
+        {
+            using Message = harurobo2022::Odometry;
+
+            struct alignas(1) RawData final
+            {
+                float pos_x{};
+                float pos_y{};
+                float rot_z{};
+            };
+
+            struct alignas(1) CanData final
+            {
+                StewLib::BigEndian<float> pos_x{};
+                StewLib::BigEndian<float> pos_y{};
+                StewLib::BigEndian<float> rot_z{};
+            };
+
+            RawData raw_data;
+            ros::Time stamp{};
+
+            MessageConvertor() = default;
+            MessageConvertor(const MessageConvertor&) = default;
+            MessageConvertor(MessageConvertor&&) = default;
+            MessageConvertor& operator=(const MessageConvertor&) = default;
+            MessageConvertor& operator=(MessageConvertor&&) = default;
+            ~MessageConvertor() = default;
+
+            MessageConvertor(const Message& msg) noexcept:
+                raw_data{msg.pos_x, msg.pos_y, msg.rot_z},
+                stamp{msg.header.stamp}
+            {}
+
+            constexpr MessageConvertor(const RawData& raw_data) noexcept:
+                raw_data{raw_data}
+            {}
+
+            operator Message() const noexcept
+            {
+                Message msg;
+                msg.header.stamp = stamp;
+                msg.pos_x = raw_data.pos_x;
+                msg.pos_y = raw_data.pos_y;
+                msg.rot_z = raw_data.rot_z;
+
+                return msg;
+            }
+
+            operator RawData() const noexcept
+            {
+                return raw_data;
+            }
+
+            operator CanData() const noexcept
+            {
+                return {raw_data.pos_x, raw_data.pos_y, raw_data.rot_z};
+            }
+        };
+    }
+}
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
+
 #include "harurobo2022/Twist.h"
 
-#include "../../lib/reverse_buffer.hpp"
+#include "../../lib/can_codec.hpp"
 #include "../template.hpp"
 
 
@@ -24,19 +26,15 @@ namespace Harurobo2022
 
             struct alignas(1) CanData final
             {
-                StewLib::ReverseBuffer<float> linear_x{};
-                StewLib::ReverseBuffer<float> linear_y{};
-                StewLib::ReverseBuffer<float> angular_z{};
-
-                void reverse() noexcept
-                {
-                    linear_x.reverse();
-                    linear_y.reverse();
-                    angular_z.reverse();
-                }
+                StewLib::BigEndian<float> linear_x{};
+                StewLib::BigEndian<float> linear_y{};
+                StewLib::BigEndian<float> angular_z{};
             };
 
             RawData raw_data;
+            // header。seqはtrace id(trace.hpp)に使う。
+            ros::Time stamp{};
+            std::uint32_t seq{};
 
             MessageConvertor() = default;
             MessageConvertor(const MessageConvertor&) = default;
@@ -45,8 +43,10 @@ namespace Harurobo2022
             MessageConvertor& operator=(MessageConvertor&&) = default;
             ~MessageConvertor() = default;
 
-            constexpr MessageConvertor(const Message& msg) noexcept:
-                MessageConvertor(RawData{msg.linear_x, msg.linear_y, msg.angular_z})
+            MessageConvertor(const Message& msg) noexcept:
+                raw_data{msg.linear_x, msg.linear_y, msg.angular_z},
+                stamp{msg.header.stamp},
+                seq{msg.header.seq}
             {}
 
             constexpr MessageConvertor(const RawData& raw_data) noexcept:
@@ -56,6 +56,8 @@ namespace Harurobo2022
             operator Message() const noexcept
             {
                 Message msg;
+                msg.header.stamp = stamp;
+                msg.header.seq = seq;
                 msg.linear_x = raw_data.linear_x;
                 msg.linear_y = raw_data.linear_y;
                 msg.angular_z = raw_data.angular_z;
@@ -70,9 +72,7 @@ namespace Harurobo2022
 
             operator CanData() const noexcept
             {
-                CanData ret{raw_data.linear_x, raw_data.linear_y, raw_data.angular_z};
-                ret.reverse();
-                return ret;
+                return {raw_data.linear_x, raw_data.linear_y, raw_data.angular_z};
             }
         };
     }
@@ -4,7 +4,7 @@
 
 #include <ros/ros.h>
 
-#include "../lib/reverse_buffer.hpp"
+#include "../lib/can_codec.hpp"
 
 namespace Harurobo2022
 {
@@ -18,7 +18,8 @@ namespace Harurobo2022
             static_assert(ros::message_traits::IsMessage<Message_>::value, "1st argument must be message.");
 
             using RawData = Message_::_data_type;
-            using CanData = StewLib::ReverseBuffer<RawData>;
+            // CANには上位バイトから載せる。
+            using CanData = StewLib::BigEndian<RawData>;
 
             RawData raw_data{};
 
@@ -49,11 +50,9 @@ namespace Harurobo2022
                 return raw_data;
             }
 
-            operator CanData() const noexcept
+            constexpr operator CanData() const noexcept
             {
-                CanData ret = raw_data;
-                ret.reverse();
-                return ret;
+                return raw_data;
             }
         };
     }
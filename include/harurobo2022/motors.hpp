@@ -4,99 +4,71 @@
 
 #include "stringlike_types.hpp"
 #include "shirasu_publisher.hpp"
+#include "shirasu_group.hpp"
 #include "config.hpp"
 
 namespace Harurobo2022
 {
     namespace
     {
-        struct DriveMotors final
+        namespace MotorsImplement
         {
-            // キューサイズを指定できないのはどうなんだ...?
-            ShirasuPublisher<StringlikeTypes::FR_drive, Config::CanId::Tx::DriveMotor::FR> FR_pub{};
-            ShirasuPublisher<StringlikeTypes::FL_drive, Config::CanId::Tx::DriveMotor::FL> FL_pub{};
-            ShirasuPublisher<StringlikeTypes::BL_drive, Config::CanId::Tx::DriveMotor::BL> BL_pub{};
-            ShirasuPublisher<StringlikeTypes::BR_drive, Config::CanId::Tx::DriveMotor::BR> BR_pub{};
-
-            void send_cmd_all(ShirasuUtil::Mode cmd) noexcept
+            namespace Drive
             {
-                // なんでキャストしてコンテナに詰め込めないんだろうか。
-                FR_pub.send_cmd(cmd);
-                FL_pub.send_cmd(cmd);
-                BL_pub.send_cmd(cmd);
-                BR_pub.send_cmd(cmd);
+                using FR = ShirasuPublisher<StringlikeTypes::FR_drive, Config::CanId::Tx::DriveMotor::FR>;
+                using FL = ShirasuPublisher<StringlikeTypes::FL_drive, Config::CanId::Tx::DriveMotor::FL>;
+                using BL = ShirasuPublisher<StringlikeTypes::BL_drive, Config::CanId::Tx::DriveMotor::BL>;
+                using BR = ShirasuPublisher<StringlikeTypes::BR_drive, Config::CanId::Tx::DriveMotor::BR>;
             }
 
-            void activate() noexcept
+            namespace Lift
             {
-                FR_pub.activate();
-                FL_pub.activate();
-                BL_pub.activate();
-                BR_pub.activate();
+                using FR = ShirasuPublisher<StringlikeTypes::FR_lift, Config::CanId::Tx::LiftMotor::FR>;
+                using FL = ShirasuPublisher<StringlikeTypes::FL_lift, Config::CanId::Tx::LiftMotor::FL>;
+                using BL = ShirasuPublisher<StringlikeTypes::BL_lift, Config::CanId::Tx::LiftMotor::BL>;
+                using BR = ShirasuPublisher<StringlikeTypes::BR_lift, Config::CanId::Tx::LiftMotor::BR>;
+                using subX = ShirasuPublisher<StringlikeTypes::subX_lift, Config::CanId::Tx::LiftMotor::subX>;
+                using subY = ShirasuPublisher<StringlikeTypes::subY_lift, Config::CanId::Tx::LiftMotor::subY>;
+                using collector = ShirasuPublisher<StringlikeTypes::collector_lift, Config::CanId::Tx::LiftMotor::collector>;
             }
+        }
 
-            void deactivate() noexcept
+        // 並びはConfig::Wheelの添え字(FR, FL, BL, BR)と同じ。send_targetsはこの順。
+        // FR_pubなどは自分の中を指す参照なので、コピーもムーブもできない(ShirasuGroupで消してある)。
+        struct DriveMotors final : ShirasuGroup<MotorsImplement::Drive::FR, MotorsImplement::Drive::FL, MotorsImplement::Drive::BL, MotorsImplement::Drive::BR>
+        {
+            // キューサイズを指定できないのはどうなんだ...?
+            MotorsImplement::Drive::FR& FR_pub{get<MotorsImplement::Drive::FR>()};
+            MotorsImplement::Drive::FL& FL_pub{get<MotorsImplement::Drive::FL>()};
+            MotorsImplement::Drive::BL& BL_pub{get<MotorsImplement::Drive::BL>()};
+            MotorsImplement::Drive::BR& BR_pub{get<MotorsImplement::Drive::BR>()};
+
+            DriveMotors() noexcept
             {
-                FR_pub.deactivate();
-                FL_pub.deactivate();
-                BL_pub.deactivate();
-                BR_pub.deactivate();
+                using namespace Config::TargetFilter::Drive;
+                set_target_filter({enable, deadband, keep_alive});
             }
         };
 
-        struct LiftMotors final
+        struct LiftMotors final :
+            ShirasuGroup
+            <
+                MotorsImplement::Lift::FR, MotorsImplement::Lift::FL, MotorsImplement::Lift::BL, MotorsImplement::Lift::BR,
+                MotorsImplement::Lift::subX, MotorsImplement::Lift::subY, MotorsImplement::Lift::collector
+            >
         {
-            ShirasuPublisher<StringlikeTypes::FR_lift, Config::CanId::Tx::LiftMotor::FR> FR_pub{};
-            ShirasuPublisher<StringlikeTypes::FL_lift, Config::CanId::Tx::LiftMotor::FL> FL_pub{};
-            ShirasuPublisher<StringlikeTypes::BL_lift, Config::CanId::Tx::LiftMotor::BL> BL_pub{};
-            ShirasuPublisher<StringlikeTypes::BR_lift, Config::CanId::Tx::LiftMotor::BR> BR_pub{};
-            ShirasuPublisher<StringlikeTypes::subX_lift, Config::CanId::Tx::LiftMotor::subX> subX_pub{};
-            ShirasuPublisher<StringlikeTypes::subY_lift, Config::CanId::Tx::LiftMotor::subY> subY_pub{};
-            ShirasuPublisher<StringlikeTypes::collector_lift, Config::CanId::Tx::LiftMotor::collector> collector_pub{};
-
-            void send_cmd_all(ShirasuUtil::Mode cmd) noexcept
-            {
-                FR_pub.send_cmd(cmd);
-                FL_pub.send_cmd(cmd);
-                BL_pub.send_cmd(cmd);
-                BR_pub.send_cmd(cmd);
-                subX_pub.send_cmd(cmd);
-                subY_pub.send_cmd(cmd);
-                collector_pub.send_cmd(cmd);
-            }
+            MotorsImplement::Lift::FR& FR_pub{get<MotorsImplement::Lift::FR>()};
+            MotorsImplement::Lift::FL& FL_pub{get<MotorsImplement::Lift::FL>()};
+            MotorsImplement::Lift::BL& BL_pub{get<MotorsImplement::Lift::BL>()};
+            MotorsImplement::Lift::BR& BR_pub{get<MotorsImplement::Lift::BR>()};
+            MotorsImplement::Lift::subX& subX_pub{get<MotorsImplement::Lift::subX>()};
+            MotorsImplement::Lift::subY& subY_pub{get<MotorsImplement::Lift::subY>()};
+            MotorsImplement::Lift::collector& collector_pub{get<MotorsImplement::Lift::collector>()};
 
             void send_target0_all() noexcept
             {
-                FR_pub.send_target(0);
-                FL_pub.send_target(0);
-                BL_pub.send_target(0);
-                BR_pub.send_target(0);
-                subX_pub.send_target(0);
-                subY_pub.send_target(0);
-                collector_pub.send_target(0);
-            }
-
-            void activate() noexcept
-            {
-                FR_pub.activate();
-                FL_pub.activate();
-                BL_pub.activate();
-                BR_pub.activate();
-                subX_pub.activate();
-                subY_pub.activate();
-                collector_pub.activate();
-            }
-
-            void deactivate() noexcept
-            {
-                FR_pub.deactivate();
-                FL_pub.deactivate();
-                BL_pub.deactivate();
-                BR_pub.deactivate();
-                subX_pub.deactivate();
-                subY_pub.deactivate();
-                collector_pub.deactivate();
+                send_target_all(0);
             }
         };
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,57 @@
+/*
+
+各ノードのクラスをそのままnodeletとして読み込めるようにする。
+HARUROBO2022_NODELETを定義してビルドすると、各*_node.cppはmainの代わりにこれを継承したクラスをプラグインとして書き出す。
+
+ラッパーのros::NodeHandleはグローバルなコールバックキューを使うので、
+マネージャのros::spin()のスレッドで全部のコールバックが回る。スタンドアロンのときと同じ。
+
+*/
+
+#pragma once
+
+#include <optional>
+
+#include <nodelet/nodelet.h>
+
+#include "lib/stringlike_type.hpp"
+#include "static_init_deinit.hpp"
+#include "this_node.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        template<class Node, class NodeName>
+        class NodeletBase : public nodelet::Nodelet
+        {
+            static_assert(StewLib::is_stringlike_type_v<NodeName>, "2nd argument must be StewLib::StringlikeType.");
+
+            // static_init_deinitより先にnodeを壊す。
+            std::optional<StaticInitDeinit> static_init_deinit{};
+            std::optional<Node> node{};
+
+        public:
+            ~NodeletBase() noexcept override
+            {
+                if(node)
+                {
+                    node.reset();
+                    NODELET_INFO("%s nodelet has terminated.", NodeName::str);
+                }
+            }
+
+        private:
+            void onInit() override
+            {
+                // プロファイラの書き出し先などがマネージャの名前にならないよう、何か作る前に入れておく。
+                ThisNode::set_name(getName());
+
+                static_init_deinit.emplace();
+                node.emplace();
+
+                NODELET_INFO("%s nodelet has started.", NodeName::str);
+            }
+        };
+    }
+}
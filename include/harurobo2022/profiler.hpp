@@ -0,0 +1,161 @@
+/*
+
+TimerとSubscriberのコールバックの実行時間と呼ばれる間隔を測る。
+Config::Profiling::enableがfalseなら何もしない(Probeも作られない)。
+
+Probeは登録簿が持っていて最後まで壊さない。ノードが壊れた後、StaticInitDeinitの後始末でまとめて吐き出すので。
+吐き出し先はROS_INFOと、Config::Profiling::dump_dir/harurobo2022_profile_<ノード名>.txt。
+ノード名はThisNode::get_name()なので、nodeletでもマネージャの名前ではなくnodeletごとに分かれる。
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <list>
+#include <string>
+
+#include <ros/ros.h>
+
+#include "lib/log_histogram.hpp"
+#include "lib/shm_ring.hpp"
+#include "config.hpp"
+#include "static_init_deinit.hpp"
+#include "this_node.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        namespace ProfilerImplement
+        {
+            struct Probe final
+            {
+                const char * name;
+                StewLib::LogHistogram<> exec_ns{};
+                StewLib::LogHistogram<> period_ns{};
+                std::atomic<std::uint64_t> last_start_ns{0};
+
+                Probe(const char *const name) noexcept:
+                    name{name}
+                {}
+
+                void record(const std::uint64_t start_ns, const std::uint64_t end_ns) noexcept
+                {
+                    exec_ns.record(end_ns - start_ns);
+
+                    const std::uint64_t last = last_start_ns.exchange(start_ns, std::memory_order_relaxed);
+                    if(last) period_ns.record(start_ns - last);
+                }
+            };
+
+            struct ProfilerBase
+            {
+                inline static std::list<Probe> probes{};
+            };
+        }
+
+        // 測る場所ごとに一つ持つ。
+        class Profiler final : ProfilerImplement::ProfilerBase
+        {
+            ProfilerImplement::Probe * probe{nullptr};
+
+        public:
+            class Scope final
+            {
+                ProfilerImplement::Probe *const probe;
+                const std::uint64_t start_ns;
+
+            public:
+                Scope(ProfilerImplement::Probe *const probe) noexcept:
+                    probe{probe},
+                    start_ns{probe ? StewLib::monotonic_ns() : 0}
+                {}
+
+                ~Scope() noexcept
+                {
+                    if(probe) probe->record(start_ns, StewLib::monotonic_ns());
+                }
+
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+            };
+
+            Profiler(const char *const name) noexcept
+            {
+                if constexpr(Config::Profiling::enable)
+                {
+                    probe = &probes.emplace_back(name);
+                }
+            }
+
+            Profiler(const Profiler&) = delete;
+            Profiler& operator=(const Profiler&) = delete;
+
+            [[nodiscard]] Scope measure() const noexcept
+            {
+                return Scope{probe};
+            }
+
+            static void dump() noexcept
+            {
+                if(probes.empty()) return;
+
+                std::string node_name = ThisNode::get_name();
+                for(auto& c : node_name) if(c == '/') c = '_';
+
+                const std::string path = std::string(Config::Profiling::dump_dir) + "/harurobo2022_profile" + node_name + ".txt";
+                std::FILE *const fp = std::fopen(path.c_str(), "w");
+                if(!fp) ROS_WARN("profiler: failed to open %s.", path.c_str());
+
+                constexpr const char * header = "%-40s %10s %10s %10s %10s %10s | %10s %10s %10s %10s [us]\n";
+                constexpr const char * row = "%-40s %10lu %10.1f %10.1f %10.1f %10.1f | %10.1f %10.1f %10.1f %10.1f\n";
+
+                if(fp) std::fprintf(fp, header, "name", "count", "exec_mean", "exec_p99", "exec_p999", "exec_max", "per_mean", "per_p1", "per_p99", "per_max");
+
+                for(const auto& probe : probes)
+                {
+                    const auto& exec = probe.exec_ns;
+                    const auto& period = probe.period_ns;
+
+                    ROS_INFO
+                    (
+                        "profiler: %s: %lu calls, exec mean %.1fus p99 %.1fus max %.1fus, period mean %.1fus p99 %.1fus max %.1fus",
+                        probe.name, exec.count(),
+                        exec.mean() / 1e3, exec.percentile(99) / 1e3, exec.max() / 1e3,
+                        period.mean() / 1e3, period.percentile(99) / 1e3, period.max() / 1e3
+                    );
+
+                    if(fp)
+                    {
+                        std::fprintf
+                        (
+                            fp, row,
+                            probe.name, exec.count(),
+                            exec.mean() / 1e3, exec.percentile(99) / 1e3, exec.percentile(99.9) / 1e3, exec.max() / 1e3,
+                            period.mean() / 1e3, period.percentile(1) / 1e3, period.percentile(99) / 1e3, period.max() / 1e3
+                        );
+                    }
+                }
+
+                if(fp) std::fclose(fp);
+            }
+        };
+
+        namespace ProfilerImplement
+        {
+            inline static const char dummy =
+            []() noexcept
+            {
+                if constexpr(Config::Profiling::enable)
+                {
+                    StaticInitDeinit::deinitialize_list.push_back([]() noexcept { Profiler::dump(); });
+                }
+
+                return 0;
+            }();
+        }
+    }
+}
@@ -14,13 +14,19 @@ ros::AdveriseOptionsを見るといかに貧弱になってるかがわかる。
 
 そこで、複数インスタンスを作るのは禁止とし、トピック名やメッセージ型は固定とした。
 
+TopicBackend::intra_processなトピックは、nodeletでビルドしたときIntraProcessBusに直接流す。
+ROSには外から購読している人がいるときだけ流す。
+
+
 */
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include <ros/ros.h>
+#include <boost/make_shared.hpp>
 
 #include "lib/stringlike_type.hpp"
 #include "topic.hpp"
@@ -75,10 +81,13 @@ namespace Harurobo2022
             using TopicName = Topic::Name;
 
         private:
+            using Channel = intra_process_channel_t<Topic>;
+
             // NodeHandleを複数個作ってもいいのかわからなかった。
             ros::NodeHandle nh{};
             std::uint32_t queue_size;
             ros::Publisher pub;
+            std::shared_ptr<Channel> channel{};
 
         public:
             Publisher(const std::uint32_t queue_size) noexcept:
@@ -91,6 +100,15 @@ namespace Harurobo2022
                 }
 
                 is_published<TopicName> = true;
+
+                if constexpr(uses_intra_process_v<Topic>)
+                {
+                    channel = IntraProcessBus::get_channel<Message, sizeof(typename MessageConvertor::RawData)>(TopicName::str);
+                    if(!channel)
+                    {
+                        ROS_ERROR("Harurobo2022::Publisher: intra process channel for %s has another type. fall back to ROS.", TopicName::str);
+                    }
+                }
             }
 
             ~Publisher() noexcept
@@ -105,7 +123,32 @@ namespace Harurobo2022
 
             void publish(const MessageConvertor& conv) const noexcept
             {
+                if constexpr(uses_intra_process_v<Topic>)
+                {
+                    if(pub && channel)
+                    {
+                        const typename MessageConvertor::RawData raw_data = conv;
+                        channel->store(&raw_data);
+
+                        // 誰も見てなければメッセージは作らない。
+                        const bool has_external = pub.getNumSubscribers() > 0;
+                        if(channel->has_subscribers() || has_external)
+                        {
+                            const auto msg_p = boost::make_shared<const Message>(static_cast<Message>(conv));
+                            channel->dispatch(msg_p);
+                            if(has_external) pub.publish(msg_p);
+                        }
+
+                        return;
+                    }
+                }
+
+#ifdef HARUROBO2022_NODELET
+                // 同じプロセス内の購読者にはシリアライズせずポインタのまま渡る。
+                if(pub) pub.publish(boost::make_shared<const Message>(static_cast<Message>(conv)));
+#else
                 if(pub) pub.publish(static_cast<Message>(conv));
+#endif
             }
 
             void change_buff_size(const std::uint32_t changed_queue_size) noexcept
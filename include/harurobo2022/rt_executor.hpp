@@ -0,0 +1,271 @@
+/*
+
+周期処理を回す専用のループ。ros::spin()の代わりにmainのスレッドをこれで占有する。
+
+ros::Timerだとジョイスティックやオドメトリのコールバックと同じキューに並ぶので、周期がそれらに押されて揺れる。
+これはclock_nanosleepで絶対時刻の締め切りまで寝て、起きたらまず周期処理を呼び、
+残りの時間でグローバルなコールバックキューに溜まったものを片付ける。
+全部同じスレッドで呼ぶので、ノードの中身はこれまで通り排他を気にしなくてよい。
+
+Config::RtExecutor::sched_priorityを1以上にするとSCHED_FIFOになる(権限が要る)。cpuを0以上にするとそのCPUに張り付く。
+起床の遅れ(ジッタ)と締め切り超過(オーバーラン)を数えて定期的に報告する。
+
+nodeletのときはマネージャがスレッドを持っているので使わない。Timerはros::Timerに戻る。
+
+周期処理だけの専用スレッドは作っていない。回しているのはmainのスレッドで、張り付けやSCHED_FIFOもそのスレッドにかける。
+別のスレッドにすると、周期処理とほかのコールバックが同じメンバを同時に触るので、どのノードにも排他を入れることになる。
+ほかのコールバックは締め切りの後にしか呼ばないので、周期の頭が押されることはない(長いコールバックがあれば次の起床が遅れる。
+その分はジッタとオーバーランに出る)。
+
+*/
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+
+#include "lib/shm_ring.hpp"
+#include "config.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        class RtExecutor final
+        {
+        public:
+            using Invoker = void (*)(void *, const ros::TimerEvent&) noexcept;
+
+            struct Stat final
+            {
+                std::uint64_t count{0};
+                std::uint64_t overruns{0};
+                std::uint64_t jitter_sum_ns{0};
+                std::uint64_t jitter_max_ns{0};
+            };
+
+        private:
+            struct Task final
+            {
+                void * context;
+                Invoker invoker;
+                std::uint64_t period_ns;
+                std::uint64_t deadline_ns;
+                ros::Time last_expected;
+                ros::Time last_real;
+            };
+
+            // Timerから自分を見つけるため。mainで一つだけ作る。
+            inline static RtExecutor * current{nullptr};
+
+            std::vector<Task> tasks{};
+            int cpu;
+
+            Stat window_stat{};
+            Stat total_stat{};
+
+        public:
+            // cpuが負なら張り付けない。
+            RtExecutor(const int cpu = -1) noexcept:
+                cpu{cpu}
+            {
+                if constexpr(!Config::RtExecutor::enable) return;
+
+                if(current)
+                {
+                    ROS_ERROR("Instance of Harurobo2022::RtExecutor has already constracted and not destructed.");
+                    return;
+                }
+
+                tasks.reserve(8);
+                current = this;
+            }
+
+            ~RtExecutor() noexcept
+            {
+                if(current == this) current = nullptr;
+            }
+
+            RtExecutor(const RtExecutor&) = delete;
+            RtExecutor& operator=(const RtExecutor&) = delete;
+            RtExecutor(RtExecutor&&) = delete;
+            RtExecutor& operator=(RtExecutor&&) = delete;
+
+            static RtExecutor * get_current() noexcept
+            {
+                return current;
+            }
+
+            void add(void *const context, const Invoker invoker, const double period) noexcept
+            {
+                const std::uint64_t period_ns = period * 1e9;
+                tasks.push_back(Task{context, invoker, period_ns, StewLib::monotonic_ns() + period_ns, {}, {}});
+            }
+
+            void remove(void *const context) noexcept
+            {
+                tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [context](const Task& task){ return task.context == context; }), tasks.end());
+            }
+
+            const Stat& get_total_stat() const noexcept
+            {
+                return total_stat;
+            }
+
+            void spin() noexcept
+            {
+                if(current != this || tasks.empty())
+                {
+                    ros::spin();
+                    return;
+                }
+
+                setup_thread();
+
+                const std::uint64_t report_interval_ns = Config::RtExecutor::report_interval * 1e9;
+                std::uint64_t next_report_ns = StewLib::monotonic_ns() + report_interval_ns;
+
+                while(ros::ok())
+                {
+                    std::uint64_t deadline_ns = std::numeric_limits<std::uint64_t>::max();
+                    for(const auto& task : tasks) deadline_ns = std::min(deadline_ns, task.deadline_ns);
+
+                    sleep_until(deadline_ns);
+
+                    const std::uint64_t woke_ns = StewLib::monotonic_ns();
+                    if(woke_ns < deadline_ns) continue;  // シグナルで起こされた
+
+                    const ros::Time now = ros::Time::now();
+
+                    // 回している間にtasksが変わることはない(Timerは構築時にしか足さない)ので添字で回す。
+                    for(std::size_t i = 0; i < tasks.size(); ++i)
+                    {
+                        Task& task = tasks[i];
+                        if(task.deadline_ns > woke_ns) continue;
+
+                        const std::uint64_t jitter_ns = woke_ns - task.deadline_ns;
+                        record_jitter(jitter_ns);
+
+                        ros::TimerEvent event;
+                        event.current_real = now;
+                        event.current_expected = now - ros::Duration(jitter_ns * 1e-9);
+                        event.last_real = task.last_real;
+                        event.last_expected = task.last_expected;
+                        task.last_real = event.current_real;
+                        task.last_expected = event.current_expected;
+
+                        task.invoker(task.context, event);
+
+                        task.deadline_ns += task.period_ns;
+
+                        // 次の締め切りを過ぎていたら、取りこぼした分は飛ばして位相だけ保つ。
+                        const std::uint64_t done_ns = StewLib::monotonic_ns();
+                        if(task.deadline_ns <= done_ns)
+                        {
+                            ++window_stat.overruns;
+                            ++total_stat.overruns;
+                            task.deadline_ns += ((done_ns - task.deadline_ns) / task.period_ns + 1) * task.period_ns;
+                        }
+                    }
+
+                    ros::getGlobalCallbackQueue()->callAvailable();
+
+                    if(woke_ns >= next_report_ns)
+                    {
+                        report();
+                        next_report_ns += report_interval_ns;
+                    }
+                }
+
+                ROS_INFO
+                (
+                    "rt_executor: total %lu ticks, jitter mean %.1fus max %.1fus, %lu overruns.",
+                    total_stat.count,
+                    total_stat.count ? static_cast<double>(total_stat.jitter_sum_ns) / total_stat.count / 1e3 : 0.0,
+                    total_stat.jitter_max_ns / 1e3,
+                    total_stat.overruns
+                );
+            }
+
+        private:
+            void setup_thread() noexcept
+            {
+                if(cpu >= 0)
+                {
+                    cpu_set_t cpu_set;
+                    CPU_ZERO(&cpu_set);
+                    CPU_SET(cpu, &cpu_set);
+                    if(const int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set))
+                    {
+                        ROS_WARN("rt_executor: failed to pin to cpu %d: %s", cpu, std::strerror(err));
+                    }
+                }
+
+                if constexpr(Config::RtExecutor::sched_priority > 0)
+                {
+                    // ページフォルトで止まらないように。
+                    if(mlockall(MCL_CURRENT | MCL_FUTURE))
+                    {
+                        ROS_WARN("rt_executor: mlockall failed: %s", std::strerror(errno));
+                    }
+
+                    sched_param param{};
+                    param.sched_priority = Config::RtExecutor::sched_priority;
+                    if(const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param))
+                    {
+                        ROS_WARN("rt_executor: failed to set SCHED_FIFO: %s", std::strerror(err));
+                    }
+                }
+            }
+
+            static void sleep_until(const std::uint64_t deadline_ns) noexcept
+            {
+                timespec ts;
+                ts.tv_sec = deadline_ns / 1'000'000'000;
+                ts.tv_nsec = deadline_ns % 1'000'000'000;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+            }
+
+            void record_jitter(const std::uint64_t jitter_ns) noexcept
+            {
+                for(Stat * stat : {&window_stat, &total_stat})
+                {
+                    ++stat->count;
+                    stat->jitter_sum_ns += jitter_ns;
+                    stat->jitter_max_ns = std::max(stat->jitter_max_ns, jitter_ns);
+                }
+            }
+
+            void report() noexcept
+            {
+                if(!window_stat.count) return;
+
+                const double mean_us = static_cast<double>(window_stat.jitter_sum_ns) / window_stat.count / 1e3;
+                const double max_us = window_stat.jitter_max_ns / 1e3;
+
+                if(window_stat.overruns)
+                {
+                    ROS_WARN("rt_executor: %lu ticks, jitter mean %.1fus max %.1fus, %lu overruns.", window_stat.count, mean_us, max_us, window_stat.overruns);
+                }
+                else
+                {
+                    ROS_DEBUG("rt_executor: %lu ticks, jitter mean %.1fus max %.1fus.", window_stat.count, mean_us, max_us);
+                }
+
+                window_stat = {};
+            }
+        };
+    }
+}
@@ -0,0 +1,119 @@
+/*
+
+ShirasuPublisherをまとめて扱う。まとめて送るときは、グループ全部のフレームを一つのCanTxBatchに続けて積み、
+途中で分かれずに並んだまま一度に送る。順番はテンプレート引数の順。
+デバッグ用のトピックへは、CANに送り終わってから流す。
+
+DriveMotorsやLiftMotorsはこれを継承している(motors.hpp)。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include "shirasu_util.hpp"
+#include "can_publisher.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        template<class ... ShirasuPublishers>
+        class ShirasuGroup
+        {
+            std::tuple<ShirasuPublishers ...> pubs{};
+
+        public:
+            constexpr static std::size_t size = sizeof...(ShirasuPublishers);
+            constexpr static std::size_t cmd_frame_count = (std::size_t{0} + ... + ShirasuPublishers::cmd_frame_count);
+            constexpr static std::size_t target_frame_count = (std::size_t{0} + ... + ShirasuPublishers::target_frame_count);
+
+            static_assert(cmd_frame_count <= CanPublisherImplement::CanPublisherBase::batch_capacity, "too many motors for one CanTxBatch.");
+            static_assert(target_frame_count <= CanPublisherImplement::CanPublisherBase::batch_capacity, "too many motors for one CanTxBatch.");
+
+            // DriveMotorsなどが中のpublisherへの参照をメンバに持つので、コピーもムーブもさせない(参照が元のものを指したままになる)。
+            ShirasuGroup() = default;
+            ShirasuGroup(const ShirasuGroup&) = delete;
+            ShirasuGroup(ShirasuGroup&&) = delete;
+            ShirasuGroup& operator=(const ShirasuGroup&) = delete;
+            ShirasuGroup& operator=(ShirasuGroup&&) = delete;
+
+            template<class ShirasuPublisher>
+            ShirasuPublisher& get() noexcept
+            {
+                return std::get<ShirasuPublisher>(pubs);
+            }
+
+            template<std::size_t index>
+            auto& get() noexcept
+            {
+                return std::get<index>(pubs);
+            }
+
+            void send_cmd_all(const ShirasuUtil::Mode cmd) noexcept
+            {
+                {
+                    CanTxBatch batch{cmd_frame_count};
+                    std::apply([cmd](auto& ... pub) noexcept { (pub.enqueue_cmd(cmd), ...); }, pubs);
+                }
+
+                std::apply([cmd](auto& ... pub) noexcept { (pub.publish_cmd(cmd), ...); }, pubs);
+            }
+
+            void send_target_all(const float target) noexcept
+            {
+                {
+                    CanTxBatch batch{target_frame_count};
+                    std::apply([target](auto& ... pub) noexcept { (pub.enqueue_target(target), ...); }, pubs);
+                }
+
+                std::apply([target](auto& ... pub) noexcept { (pub.publish_target(target), ...); }, pubs);
+            }
+
+            // targets[i]をi番目のモーターへ。
+            template<class T>
+            void send_targets(const T (&targets)[size]) noexcept
+            {
+                static_assert(std::is_convertible_v<T, float>, "target must be convertible to float.");
+
+                {
+                    CanTxBatch batch{target_frame_count};
+                    for_each_indexed([&targets](auto& pub, const std::size_t i) noexcept { pub.enqueue_target(targets[i]); });
+                }
+
+                for_each_indexed([&targets](auto& pub, const std::size_t i) noexcept { pub.publish_target(targets[i]); });
+            }
+
+            void set_target_filter(const TargetFilter& filter) noexcept
+            {
+                std::apply([&filter](auto& ... pub) noexcept { (pub.set_target_filter(filter), ...); }, pubs);
+            }
+
+            void activate() noexcept
+            {
+                std::apply([](auto& ... pub) noexcept { (pub.activate(), ...); }, pubs);
+            }
+
+            void deactivate() noexcept
+            {
+                std::apply([](auto& ... pub) noexcept { (pub.deactivate(), ...); }, pubs);
+            }
+
+        private:
+            template<class F>
+            void for_each_indexed(const F& f) noexcept
+            {
+                for_each_indexed(f, std::index_sequence_for<ShirasuPublishers ...>());
+            }
+
+            template<class F, std::size_t ... indices>
+            void for_each_indexed(const F& f, std::index_sequence<indices ...>) noexcept
+            {
+                (f(std::get<indices>(pubs), indices), ...);
+            }
+        };
+    }
+}
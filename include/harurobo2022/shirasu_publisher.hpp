@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <cmath>
+
+#include <ros/ros.h>
 
 #include "shirasu_util.hpp"
 #include "std_msgs_convertor.hpp"
@@ -12,6 +16,19 @@ namespace Harurobo2022
 {
     namespace
     {
+        /*
+        targetの送り方。enableならtargetが前に送った値からdeadbandより大きく変わったときと、
+        最後に送ってからkeep_alive[s]経ったときだけCANに送る。0への変化は必ず送る。
+        cmdを送ったり(非)活性化したりしたら覚えていた値は忘れ、次のtargetは必ず送る。
+        デバッグ用のトピックへは毎回流す(流すかどうかはdebug_mirror.hpp)。
+        */
+        struct TargetFilter final
+        {
+            bool enable{false};
+            double deadband{0};
+            double keep_alive{0};
+        };
+
         template<class MotorName_, std::uint16_t bid_>
         class ShirasuPublisher final
         {
@@ -27,15 +44,49 @@ namespace Harurobo2022
             // debug
             CanPublisher<target> target_canpub{1000};
 
+            TargetFilter target_filter{};
+            float last_target{0};
+            std::uint64_t last_target_ns{0};
+            bool has_last_target{false};
+
         public:
+            constexpr static std::size_t cmd_frame_count = CanPublisher<cmd>::frame_count;
+            constexpr static std::size_t target_frame_count = CanPublisher<target>::frame_count;
+
+            void set_target_filter(const TargetFilter& filter) noexcept
+            {
+                target_filter = filter;
+                has_last_target = false;
+            }
+
             void send_cmd(const ShirasuUtil::Mode cmd) noexcept
             {
-                cmd_canpub.can_publish(cmd);
+                enqueue_cmd(cmd);
+                cmd_canpub.publish(cmd);
             }
 
             void send_target(const float target) noexcept
             {
-                target_canpub.can_publish(target);
+                enqueue_target(target);
+                target_canpub.publish(target);
+            }
+
+            // CANに送るだけ。デバッグ用のトピックにはpublish_cmd/publish_targetで別に流す。
+            void enqueue_cmd(const ShirasuUtil::Mode cmd) noexcept
+            {
+                has_last_target = false;
+                cmd_canpub.can_enqueue(cmd);
+            }
+
+            void enqueue_target(const float target) noexcept
+            {
+                if(!pass_target_filter(target))
+                {
+                    count_suppressed_frames(target_frame_count);
+                    return;
+                }
+
+                target_canpub.can_enqueue(target);
             }
 
             void publish_cmd(const ShirasuUtil::Mode cmd) noexcept
@@ -50,15 +101,38 @@ namespace Harurobo2022
 
             void activate() noexcept
             {
+                has_last_target = false;
                 cmd_canpub.activate();
                 target_canpub.activate();
             }
 
             void deactivate() noexcept
             {
+                has_last_target = false;
                 cmd_canpub.deactivate();
                 target_canpub.deactivate();
             }
+
+        private:
+            bool pass_target_filter(const float target) noexcept
+            {
+                if(!target_filter.enable) return true;
+
+                const std::uint64_t now_ns = ros::Time::now().toNSec();
+                const bool is_due = !has_last_target
+                    || (target == 0 && last_target != 0)
+                    || std::fabs(target - last_target) > target_filter.deadband
+                    || (now_ns - last_target_ns) * 1e-9 >= target_filter.keep_alive;
+
+                if(is_due)
+                {
+                    last_target = target;
+                    last_target_ns = now_ns;
+                    has_last_target = true;
+                }
+
+                return is_due;
+            }
         };
     }
 }
\ No newline at end of file
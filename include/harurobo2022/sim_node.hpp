@@ -0,0 +1,67 @@
+/*
+
+各ノードのクラスをシミュレータ(sim/)に読み込めるようにする。nodelet.hppのシミュレーション版。
+HARUROBO2022_SIMを定義してビルドすると、各*_node.cppはmainの代わりにHARUROBO2022_SIM_EXPORT_NODEで自分を登録する。
+
+ノードを作る間と壊す間は、そのノードの中にいることにする(ログの名前とthis_node::getName用)。
+
+*/
+
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include <ros/ros.h>
+#include <harurobo2022_sim/world.hpp>
+
+#include "lib/stringlike_type.hpp"
+#include "static_init_deinit.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        template<class Node, class NodeName>
+        class SimNode final : public Sim::NodeBase
+        {
+            static_assert(StewLib::is_stringlike_type_v<NodeName>, "2nd argument must be StewLib::StringlikeType.");
+
+            // static_init_deinitより先にnodeを壊す。
+            std::optional<StaticInitDeinit> static_init_deinit{};
+            std::optional<Node> node{};
+
+        public:
+            SimNode() noexcept
+            {
+                const Sim::NodeScope scope{NodeName::str};
+
+                static_init_deinit.emplace();
+                node.emplace();
+
+                ROS_INFO("%s node has started.", NodeName::str);
+            }
+
+            ~SimNode() noexcept override
+            {
+                const Sim::NodeScope scope{NodeName::str};
+
+                node.reset();
+                static_init_deinit.reset();
+
+                ROS_INFO("%s node has terminated.", NodeName::str);
+            }
+
+            static std::unique_ptr<Sim::NodeBase> create() noexcept
+            {
+                return std::make_unique<SimNode>();
+            }
+        };
+    }
+}
+
+#define HARUROBO2022_SIM_EXPORT_NODE(Node, NodeName) \
+    namespace \
+    { \
+        [[maybe_unused]] const bool harurobo2022_sim_node_registered = ::Harurobo2022::Sim::register_node(NodeName::str, &::Harurobo2022::SimNode<Node, NodeName>::create); \
+    }
@@ -15,13 +15,14 @@ namespace Harurobo2022
             Stew_StringlikeType(auto_commander_active)
             Stew_StringlikeType(manual_commander)
             Stew_StringlikeType(can_tx)
+            Stew_StringlikeType(can_shm_bridge)
+            Stew_StringlikeType(can_rx)
+            Stew_StringlikeType(can_recorder)
+            Stew_StringlikeType(can_replayer)
             Stew_StringlikeType(shutdown)
             Stew_StringlikeType(state)
             Stew_StringlikeType(body_twist)
             Stew_StringlikeType(odometry)
-            Stew_StringlikeType(odometry_x)
-            Stew_StringlikeType(odometry_y)
-            Stew_StringlikeType(odometry_yaw)
             Stew_StringlikeType(FR_drive)
             Stew_StringlikeType(FL_drive)
             Stew_StringlikeType(BL_drive)
@@ -6,16 +6,22 @@
 コンパイル時にコールバック関数を追加する方法をなかなか思いつかなかったのと、そもそも使用例がなさそうなのと、
 なにより春ロボまでの残り時間が少ないので今回は諦める。
 
+TopicBackend::intra_processなトピックは、nodeletでビルドしたときIntraProcessBusから受け取る。ROSの購読は作らない。
+このときコールバックはpublishしたスレッドでその場で呼ばれる。latest()で最新値を直接覗くこともできる。
+
 */
 
 #pragma once
 
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
 
 #include <ros/ros.h>
 
 #include "topic.hpp"
+#include "profiler.hpp"
 
 
 namespace Harurobo2022
@@ -52,21 +58,82 @@ namespace Harurobo2022
         public:
             using Message = Topic::Message;
             using TopicName = Topic::Name;
+            using MessageConvertor = Topic::MessageConvertor;
 
         private:
+            using Channel = intra_process_channel_t<Topic>;
+
             using CallbackSignature = void(const typename Message::ConstPtr&);
             // ros::NodeHandleがわからない...ってかROSわかんないよぉ...
             ros::NodeHandle nh{};
             std::uint32_t queue_size;
+            Profiler profiler{TopicName::str};
             std::function<CallbackSignature> callback;
             ros::Subscriber sub;
+            std::shared_ptr<Channel> channel{};
+            bool is_intra_active{false};
+
+            bool is_intra() const noexcept
+            {
+                if constexpr(uses_intra_process_v<Topic>) return static_cast<bool>(channel);
+                else return false;
+            }
+
+            void subscribe() noexcept
+            {
+                if constexpr(uses_intra_process_v<Topic>)
+                {
+                    if(channel)
+                    {
+                        if(!is_intra_active)
+                        {
+                            is_intra_active = channel->subscribe(&callback);
+                            if(!is_intra_active) ROS_ERROR("Harurobo2022::Subscriber: too many intra process subscribers for %s.", TopicName::str);
+                        }
+                        return;
+                    }
+                }
+
+                sub = nh.subscribe<Message>(TopicName::str, queue_size, callback);
+            }
+
+            void unsubscribe() noexcept
+            {
+                if constexpr(uses_intra_process_v<Topic>)
+                {
+                    if(channel)
+                    {
+                        channel->unsubscribe(&callback);
+                        is_intra_active = false;
+                        return;
+                    }
+                }
+
+                sub = ros::Subscriber();
+            }
+
+            template<class F>
+            std::function<CallbackSignature> measured(const F& f) noexcept
+            {
+                if constexpr(Config::Profiling::enable)
+                {
+                    return [this, f](const typename Message::ConstPtr& msg_p)
+                    {
+                        const auto scope = profiler.measure();
+                        f(msg_p);
+                    };
+                }
+                else
+                {
+                    return f;
+                }
+            }
 
         public:
             template<class F>
             Subscriber(const std::uint32_t queue_size,const F& callback) noexcept:
                 queue_size{queue_size},
-                callback{callback},
-                sub{nh.subscribe<Message>(TopicName::str, queue_size, this->callback)}
+                callback{measured(callback)}
             {
                 if(is_subscribed<TopicName>)
                 {
@@ -74,10 +141,22 @@ namespace Harurobo2022
                 }
 
                 is_subscribed<TopicName> = true;
+
+                if constexpr(uses_intra_process_v<Topic>)
+                {
+                    channel = IntraProcessBus::get_channel<Message, sizeof(typename MessageConvertor::RawData)>(TopicName::str);
+                    if(!channel)
+                    {
+                        ROS_ERROR("Harurobo2022::Subscriber: intra process channel for %s has another type. fall back to ROS.", TopicName::str);
+                    }
+                }
+
+                subscribe();
             }
 
             ~Subscriber() noexcept
             {
+                unsubscribe();
                 is_subscribed<TopicName> = false;
             }
 
@@ -88,8 +167,9 @@ namespace Harurobo2022
 
             void change_buff_size(const std::uint32_t changed_queue_size) noexcept
             {
-                sub = nh.subscribe<Message>(TopicName::str, changed_queue_size, callback);
                 queue_size = changed_queue_size;
+                // intra processにはキューがない。
+                if(!is_intra()) sub = nh.subscribe<Message>(TopicName::str, changed_queue_size, callback);
             }
 
             void change_buff_size_if_larger(const std::uint32_t changed_queue_size) noexcept
@@ -100,11 +180,14 @@ namespace Harurobo2022
                 }
             }
 
+            // intra processのとき、publish中に呼ぶと古いコールバックと競合する。publishするスレッドから呼ぶこと。
             template<class F>
             void change_callback(const F& changed_callback) noexcept
             {
-                sub = nh.subscribe<Message>(TopicName::str, queue_size, changed_callback);
-                callback = changed_callback;
+                const bool was_intra_active = is_intra_active;
+                if(is_intra()) unsubscribe();
+                callback = measured(changed_callback);
+                if(!is_intra() || was_intra_active) subscribe();
             }
 
             ros::Subscriber get_sub() const noexcept
@@ -114,12 +197,30 @@ namespace Harurobo2022
 
             void deactivate() noexcept
             {
-                sub = ros::Subscriber();
+                unsubscribe();
             }
 
             void activate() noexcept
             {
-                sub = nh.subscribe<Message>(TopicName::str, queue_size, callback);
+                subscribe();
+            }
+
+            // 最後にpublishされた値。intra processのときだけ値が入る。
+            // MessageConvertorが完全でないメッセージもあるので、使われたときだけ実体化されるようにテンプレートにしている。
+            template<class Topic2 = Topic>
+            std::optional<typename Topic2::MessageConvertor> latest() const noexcept
+            {
+                if constexpr(uses_intra_process_v<Topic2>)
+                {
+                    if(channel)
+                    {
+                        typename Topic2::MessageConvertor::RawData raw_data;
+                        channel->load(&raw_data);
+                        return typename Topic2::MessageConvertor{raw_data};
+                    }
+                }
+
+                return std::nullopt;
             }
         };
     }
@@ -0,0 +1,40 @@
+/*
+
+このノードの名前。ros::this_node::getName()の代わりに使う。
+nodeletとして読み込むとros::this_node::getName()はマネージャの名前になり、同じマネージャの全部のnodeletで同じになる。
+なのでNodeletBaseがonInitでnodeletの名前(プライベートな名前空間と同じ)を入れておく。
+スタンドアロンとシミュレータではros::this_node::getName()のまま。
+
+翻訳単位(ノード)ごとに一つ。
+
+*/
+
+#pragma once
+
+#include <string>
+
+#include <ros/ros.h>
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        namespace ThisNode
+        {
+            namespace ThisNodeImplement
+            {
+                inline std::string name{};
+            }
+
+            inline void set_name(const std::string& name) noexcept
+            {
+                ThisNodeImplement::name = name;
+            }
+
+            inline std::string get_name() noexcept
+            {
+                return ThisNodeImplement::name.empty() ? ros::this_node::getName() : ThisNodeImplement::name;
+            }
+        }
+    }
+}
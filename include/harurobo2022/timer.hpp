@@ -1,9 +1,24 @@
+/*
+
+RtExecutorが作られていればそれに登録し、なければros::Timerを使う。
+どちらでもコールバックは一段のstd::functionで呼ぶ。止めている間はフラグを見て何もしない。
+nameはProfilerの表示に使う。
+
+コールバックの型をテンプレートで持って中に展開することはしていない。Timerはどのノードでもクラスのメンバで、
+メンバにはクラステンプレートの引数推論が効かないので、ラムダの型を書けない。
+1周期あたりの関数ポインタ経由の呼び出しが一回増えるだけなので、1kHzならジッタには効かない。
+
+*/
+
 #pragma once
 
 #include <functional>
 
 #include <ros/ros.h>
 
+#include "rt_executor.hpp"
+#include "profiler.hpp"
+
 namespace Harurobo2022
 {
     namespace
@@ -14,9 +29,11 @@ namespace Harurobo2022
 
             ros::NodeHandle nh{};
 
+            Profiler profiler;
             std::function<CallbackSignature> callback;
-            std::function<CallbackSignature> inner_callback;
-            ros::Timer tim;
+            bool is_active{true};
+            RtExecutor * rt_executor{RtExecutor::get_current()};
+            ros::Timer tim{};
 
             Timer(const Timer&) = delete;
             Timer& operator=(const Timer&) = delete;
@@ -25,19 +42,32 @@ namespace Harurobo2022
 
         public:
             template<class F>
-            Timer(const double period, const F& callback) noexcept:
-                callback{callback},
-                inner_callback{callback},
-                tim{nh.createTimer(ros::Duration(period), &Timer::callback_wrapper, this)}
-            {}
+            Timer(const double period, const F& callback, const char *const name = "timer") noexcept:
+                profiler{name},
+                callback{callback}
+            {
+                if(rt_executor)
+                {
+                    rt_executor->add(this, &Timer::invoke, period);
+                }
+                else
+                {
+                    tim = nh.createTimer(ros::Duration(period), &Timer::callback_wrapper, this);
+                }
+            }
+
+            ~Timer() noexcept
+            {
+                if(rt_executor) rt_executor->remove(this);
+            }
 
             template<class F>
             void change_callback(const F& changed_callback) noexcept
             {
-                inner_callback = changed_callback;
                 callback = changed_callback;
             }
 
+            // RtExecutorで回っているときは空。
             ros::Timer get_tim() const noexcept
             {
                 return tim;
@@ -45,20 +75,27 @@ namespace Harurobo2022
 
             void activate() noexcept
             {
-                inner_callback = callback;
+                is_active = true;
             }
 
             void deactivate() noexcept
             {
-                inner_callback = [](const auto&){};
+                is_active = false;
             }
 
         private:
             void callback_wrapper(const ros::TimerEvent& event) noexcept
             {
-                inner_callback(event);
+                if(!is_active) return;
+
+                const auto scope = profiler.measure();
+                callback(event);
             }
 
+            static void invoke(void *const self, const ros::TimerEvent& event) noexcept
+            {
+                static_cast<Timer *>(self)->callback_wrapper(event);
+            }
         };
     }
-}
\ No newline at end of file
+}
@@ -1,19 +1,31 @@
 #pragma once
 
+#include <cstdint>
 #include <type_traits>
 
 #include <ros/ros.h>
 
 #include "lib/stringlike_type.hpp"
 #include "message_convertor/all.hpp"
+#include "intra_process_bus.hpp"
 
 namespace Harurobo2022
 {
     namespace
     {
+        // intra_processのトピックは、nodeletとしてビルドしたときだけIntraProcessBusで渡す。
+        enum class TopicBackend : std::uint8_t
+        {
+            ros,
+            intra_process
+        };
+
         namespace TopicImplement
         {
-            struct TopicBase{};
+            struct TopicBase
+            {
+                constexpr static TopicBackend backend = TopicBackend::ros;
+            };
             struct CanTxTopicBase: TopicBase{};
             struct CanRxTopicBase: TopicBase{};
         }
@@ -38,11 +50,20 @@ namespace Harurobo2022
         template<class T>
         inline constexpr bool is_can_topic_v = std::is_base_of_v<TopicImplement::CanTxTopicBase, T> || std::is_base_of_v<TopicImplement::CanRxTopicBase, T>;
 
-        template<class Name_, class Message_>
+        template<class T>
+        inline constexpr bool uses_intra_process_v =
+#ifdef HARUROBO2022_NODELET
+            T::backend == TopicBackend::intra_process;
+#else
+            false;
+#endif
+
+        template<class Name_, class Message_, TopicBackend backend_ = TopicBackend::ros>
         struct Topic: TopicImplement::TopicBase
         {
             using Name = Name_;
             using Message = Message_;
+            constexpr static TopicBackend backend = backend_;
 
             static_assert(StewLib::is_stringlike_type_v<Name_>, "1st argument must be StewLib::StringlikeType.");
             static_assert(ros::message_traits::IsMessage<Message_>::value, "2nd argument must be message.");
@@ -75,5 +96,27 @@ namespace Harurobo2022
 
             using MessageConvertor = Harurobo2022::MessageConvertor<Message_>;
         };
+
+        namespace TopicImplement
+        {
+            // RawDataを持たないメッセージもあるので、intra processなトピックのときだけ中身を見る。
+            template<class Topic, bool = uses_intra_process_v<Topic>>
+            struct IntraProcessChannel
+            {
+                using type = void;
+            };
+
+            template<class Topic>
+            struct IntraProcessChannel<Topic, true>
+            {
+                using RawData = Topic::MessageConvertor::RawData;
+                static_assert(std::is_trivially_copyable_v<RawData>, "RawData of intra process topic must be trivially copyable.");
+
+                using type = IntraProcessBus::Channel<typename Topic::Message, sizeof(RawData)>;
+            };
+        }
+
+        template<class Topic>
+        using intra_process_channel_t = TopicImplement::IntraProcessChannel<Topic>::type;
     }
 }
\ No newline at end of file
@@ -9,7 +9,7 @@ namespace Harurobo2022
     {
         namespace Topics
         {
-            using auto_commander_active = Topic<StringlikeTypes::auto_commander_active, std_msgs::Bool>;
+            using auto_commander_active = Topic<StringlikeTypes::auto_commander_active, std_msgs::Bool, TopicBackend::intra_process>;
         }
     }
 }
\ No newline at end of file
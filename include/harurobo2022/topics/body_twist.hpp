@@ -11,7 +11,7 @@ namespace Harurobo2022
     {
         namespace Topics
         {
-            using body_twist = Topic<StringlikeTypes::body_twist, harurobo2022::Twist>;
+            using body_twist = Topic<StringlikeTypes::body_twist, harurobo2022::Twist, TopicBackend::intra_process>;
         }
     }
 }
\ No newline at end of file
@@ -9,7 +9,7 @@ namespace Harurobo2022
     {
         namespace Topics
         {
-            using under_carriage_4wheel_active = Topic<StringlikeTypes::under_carriage_4wheel_active, std_msgs::Bool>;
+            using under_carriage_4wheel_active = Topic<StringlikeTypes::under_carriage_4wheel_active, std_msgs::Bool, TopicBackend::intra_process>;
         }
     }
 }
\ No newline at end of file
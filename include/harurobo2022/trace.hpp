@@ -0,0 +1,153 @@
+/*
+
+ジョイスティックからCANフレームまでの遅れを追いかけるための記録。
+
+manual_commanderがJoyを受け取るたびに番号(trace id)を振り、
+Twistのheader.seqにその番号、header.stampにJoyのstampを入れて流す。
+under_carriage_4wheelは番号が変わった最初の周期で、ホイール速度を計算し終えた時刻と
+そのとき積んだCANフレームの時刻を同じ番号で記録する(フレームのheaderにも入れる)。
+
+段階:
+    input       joy_nodeがJoyにつけたstamp
+    command     manual_commanderがbody_twistを流した
+    kinematics  under_carriage_4wheelがホイール速度を計算し終えた
+    can_enqueue CANフレームを送信キューに積んだ
+
+時刻はどれもros::Timeのナノ秒。プロセスを跨いで比べるため。
+記録はメモリに溜めておき、終了時にStaticInitDeinitの後始末で
+Config::Tracing::dir/harurobo2022_trace_<ノード名>.csvに書き出す。集計はtools/trace_report。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "config.hpp"
+#include "static_init_deinit.hpp"
+#include "this_node.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        namespace Trace
+        {
+            enum class Stage : std::uint8_t
+            {
+                input,
+                command,
+                kinematics,
+                can_enqueue
+            };
+
+            namespace TraceImplement
+            {
+                struct Record final
+                {
+                    std::uint32_t trace_id;
+                    Stage stage;
+                    std::uint64_t stamp_ns;
+                };
+
+                inline static std::vector<Record> records{};
+                inline static std::size_t dropped{0};
+
+                // 今送っているCANフレームがどの番号に属するか。0なら追いかけていない。
+                inline static std::uint32_t current_id{0};
+
+                inline void dump() noexcept
+                {
+                    if(records.empty()) return;
+
+                    std::string node_name = ThisNode::get_name();
+                    for(auto& c : node_name) if(c == '/') c = '_';
+
+                    const std::string path = std::string(Config::Tracing::dir) + "/harurobo2022_trace" + node_name + ".csv";
+                    std::FILE *const fp = std::fopen(path.c_str(), "w");
+                    if(!fp)
+                    {
+                        ROS_WARN("trace: failed to open %s.", path.c_str());
+                        return;
+                    }
+
+                    std::fprintf(fp, "trace_id,stage,stamp_ns\n");
+                    for(const auto& record : records)
+                    {
+                        std::fprintf(fp, "%u,%u,%lu\n", record.trace_id, static_cast<unsigned>(record.stage), record.stamp_ns);
+                    }
+                    std::fclose(fp);
+
+                    ROS_INFO("trace: %zu records written to %s (%zu dropped).", records.size(), path.c_str(), dropped);
+                }
+
+                inline static const char dummy =
+                []() noexcept
+                {
+                    if constexpr(Config::Tracing::enable)
+                    {
+                        StaticInitDeinit::initialize_list.push_back([]() noexcept { records.reserve(Config::Tracing::capacity); });
+                        StaticInitDeinit::deinitialize_list.push_back(dump);
+                    }
+
+                    return 0;
+                }();
+            }
+
+            inline void record(const std::uint32_t trace_id, const Stage stage, const ros::Time& stamp) noexcept
+            {
+                if constexpr(!Config::Tracing::enable) return;
+
+                if(!trace_id) return;
+
+                // 周期の途中で確保が走らないよう、溢れたら捨てる。
+                if(TraceImplement::records.size() == TraceImplement::records.capacity())
+                {
+                    ++TraceImplement::dropped;
+                    return;
+                }
+
+                TraceImplement::records.push_back({trace_id, stage, stamp.toNSec()});
+            }
+
+            inline void record(const std::uint32_t trace_id, const Stage stage) noexcept
+            {
+                if constexpr(!Config::Tracing::enable) return;
+
+                record(trace_id, stage, ros::Time::now());
+            }
+
+            inline std::uint32_t current_id() noexcept
+            {
+                return TraceImplement::current_id;
+            }
+
+            // 生きている間に積まれたCANフレームはtrace_idのものとして記録される。
+            class Scope final
+            {
+                const std::uint32_t old_id;
+
+            public:
+                Scope(const std::uint32_t trace_id) noexcept:
+                    old_id{TraceImplement::current_id}
+                {
+                    if constexpr(Config::Tracing::enable) TraceImplement::current_id = trace_id;
+                }
+
+                ~Scope() noexcept
+                {
+                    if constexpr(Config::Tracing::enable) TraceImplement::current_id = old_id;
+                }
+
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+            };
+        }
+    }
+}
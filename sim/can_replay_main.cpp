@@ -0,0 +1,108 @@
+/*
+
+can_recorderのログ(can_log.hpp)のcan_rxのフレームを、ROSなしでcan_subscriberに流して受信側を測る。
+
+使い方:
+    harurobo2022_can_replay log [--repeat n]
+
+シミュレーションの時計は記録した時刻に合わせて進めるので、組み立てのタイムアウトなどは記録したときと同じように効く。
+待ちはしないので、実時間では最速で流れる。1フレームあたりの時間と、組み立てられたodometryの数を出す。
+コールバックごとの実行時間はProfilerがcan_subscriberの終了時に出す。
+
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <ros/ros.h>
+#include <can_plugins/Frame.h>
+#include <harurobo2022/Odometry.h>
+
+#include "harurobo2022/can_log.hpp"
+#include "harurobo2022/stringlike_types.hpp"
+
+using namespace Harurobo2022;
+
+int main(int argc, char ** argv)
+{
+    if(argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s log [--repeat n]\n", argv[0]);
+        return 2;
+    }
+
+    std::size_t repeat = 1;
+    for(int i = 2; i + 1 < argc; i += 2)
+    {
+        if(!std::strcmp(argv[i], "--repeat")) repeat = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+
+    const char * what = "";
+    const auto reader = CanLogReader::open(argv[1], what);
+    if(!reader)
+    {
+        std::fprintf(stderr, "failed to open %s. %s\n", argv[1], what);
+        return 1;
+    }
+
+    ros::NodeHandle nh{};
+    const ros::Publisher can_rx_pub = nh.advertise<can_plugins::Frame>(StringlikeTypes::can_rx::str, 1000);
+
+    std::uint64_t odometry_count = 0;
+    const ros::Subscriber odometry_sub = nh.subscribe<harurobo2022::Odometry>
+    (
+        StringlikeTypes::odometry::str, 1000,
+        [&odometry_count](const harurobo2022::Odometry::ConstPtr&) { ++odometry_count; }
+    );
+
+    std::vector<std::unique_ptr<Sim::NodeBase>> nodes;
+    for(const auto& [name, factory] : Sim::get_node_factories())
+    {
+        nodes.push_back(factory());
+    }
+
+    std::vector<can_plugins::Frame> frames;
+    std::vector<std::uint64_t> offsets_ns;
+    for(const auto& record : *reader)
+    {
+        if(record.direction != CanLogDirection::rx) continue;
+
+        frames.push_back(record.frame);
+        offsets_ns.push_back(record.stamp_ns - (*reader)[0].stamp_ns);
+    }
+
+    const std::uint64_t span_ns = offsets_ns.empty() ? 0 : offsets_ns.back() + 1;
+
+    std::chrono::steady_clock::duration elapsed{};
+    for(std::size_t n = 0; n < repeat; ++n)
+    {
+        const std::uint64_t base_ns = Sim::now_ns();
+
+        const auto wall_start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0; i < frames.size(); ++i)
+        {
+            Sim::run_until(base_ns + offsets_ns[i]);
+            can_rx_pub.publish(frames[i]);
+            Sim::deliver_pending();
+        }
+        elapsed += std::chrono::steady_clock::now() - wall_start;
+
+        Sim::run_until(base_ns + span_ns);
+    }
+
+    nodes.clear();
+
+    const double wall_time = std::chrono::duration<double>(elapsed).count();
+    const std::size_t total = frames.size() * repeat;
+
+    std::printf("records:      %zu (%zu rx, %lu dropped while recording)\n", reader->size(), frames.size(), static_cast<unsigned long>(reader->dropped()));
+    std::printf("replayed:     %zu frames in %.3f s wall (%.3f s recorded x %zu)\n", total, wall_time, span_ns * 1e-9, repeat);
+    std::printf("per frame:    %.1f ns\n", total ? wall_time * 1e9 / total : 0.0);
+    std::printf("odometry:     %lu samples\n", static_cast<unsigned long>(odometry_count));
+
+    return 0;
+}
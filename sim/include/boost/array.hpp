@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace boost
+{
+    // メッセージの固定長配列。elemsを直接触っているところがあるので、std::arrayではなくboost::arrayと同じ形にする。
+    template<class T, std::size_t N>
+    struct array
+    {
+        T elems[N];
+
+        T& operator[](const std::size_t i) noexcept { return elems[i]; }
+        const T& operator[](const std::size_t i) const noexcept { return elems[i]; }
+
+        T * data() noexcept { return elems; }
+        const T * data() const noexcept { return elems; }
+
+        T * begin() noexcept { return elems; }
+        T * end() noexcept { return elems + N; }
+        const T * begin() const noexcept { return elems; }
+        const T * end() const noexcept { return elems + N; }
+
+        static constexpr std::size_t size() noexcept { return N; }
+    };
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "shared_ptr.hpp"
+
+namespace boost
+{
+    using std::make_shared;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <memory>
+
+// シミュレーションではメッセージのポインタをstd::shared_ptrにする。
+namespace boost
+{
+    using std::shared_ptr;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include <boost/array.hpp>
+#include <std_msgs/Header.h>
+#include <ros/sim_message.h>
+
+namespace can_plugins
+{
+    struct Frame
+    {
+        std_msgs::Header header{};
+        std::uint32_t id{};
+        std::uint8_t is_rtr{};
+        std::uint8_t is_extended{};
+        std::uint8_t is_error{};
+        std::uint8_t dlc{};
+        boost::array<std::uint8_t, 8> data{};
+
+        HARUROBO2022_SIM_MESSAGE(Frame)
+    };
+
+    using FrameConstPtr = Frame::ConstPtr;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ros/sim_message.h>
+
+namespace geometry_msgs
+{
+    struct Vector3
+    {
+        double x{};
+        double y{};
+        double z{};
+
+        HARUROBO2022_SIM_MESSAGE(Vector3)
+    };
+
+    struct Twist
+    {
+        Vector3 linear{};
+        Vector3 angular{};
+
+        HARUROBO2022_SIM_MESSAGE(Twist)
+    };
+
+    using TwistConstPtr = Twist::ConstPtr;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <std_msgs/Header.h>
+#include <ros/sim_message.h>
+
+namespace harurobo2022
+{
+    struct Odometry
+    {
+        std_msgs::Header header{};
+        float pos_x{};
+        float pos_y{};
+        float rot_z{};
+
+        HARUROBO2022_SIM_MESSAGE(Odometry)
+    };
+
+    using OdometryConstPtr = Odometry::ConstPtr;
+}
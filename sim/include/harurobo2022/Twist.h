@@ -0,0 +1,19 @@
+#pragma once
+
+#include <std_msgs/Header.h>
+#include <ros/sim_message.h>
+
+namespace harurobo2022
+{
+    struct Twist
+    {
+        std_msgs::Header header{};
+        float linear_x{};
+        float linear_y{};
+        float angular_z{};
+
+        HARUROBO2022_SIM_MESSAGE(Twist)
+    };
+
+    using TwistConstPtr = Twist::ConstPtr;
+}
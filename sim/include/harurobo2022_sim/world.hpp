@@ -0,0 +1,399 @@
+/*
+
+シミュレーション用のROSの代わり(sim/include/ros/ros.h)の中身。時計、トピック、タイマー、ノードの登録簿。
+
+・時計はシミュレーション時間で、step()でいちばん近いタイマーの時刻まで飛ぶ。実時間は待たない。
+・publishされたメッセージはその場では配らず溜めておき、今のコールバックが終わったら順に配る(スピナーが1本のときと同じ)。
+・キューの長さは見ない。溜めたものは全部配る。
+
+ノードは別々の翻訳単位なので、intra_process_bus.hppと同じく名前付きの名前空間に置き、関数内のstaticで共有する。
+ROSに依存しない。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdarg>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+namespace Harurobo2022::Sim
+{
+    // 0だとros::Time::isZero()に引っかかるので1秒から始める。
+    inline constexpr std::uint64_t start_ns = 1'000'000'000;
+
+    struct Subscription final
+    {
+        std::string topic;
+        std::type_index type;
+        std::string node;
+        std::function<void(const std::shared_ptr<const void>&)> callback;
+    };
+
+    struct Advertisement final
+    {
+        std::string topic;
+        std::type_index type;
+        // 購読者が増えたとき、減ったとき(ros::SubscriberStatusCallbackの代わり)。引数は購読したノードの名前。
+        std::function<void(const std::string&)> on_connect{};
+        std::function<void(const std::string&)> on_disconnect{};
+    };
+
+    struct TimerEntry final
+    {
+        std::uint64_t period_ns;
+        std::uint64_t next_ns;
+        std::uint64_t last_expected_ns{0};
+        std::uint64_t last_real_ns{0};
+        std::uint64_t order;
+        std::string node;
+        bool is_oneshot{false};
+        bool is_running{true};
+        // (今回の予定時刻, 前回の予定時刻, 前回の実時刻)
+        std::function<void(std::uint64_t, std::uint64_t, std::uint64_t)> callback;
+    };
+
+    class NodeBase
+    {
+    public:
+        virtual ~NodeBase() = default;
+    };
+
+    using NodeFactory = std::unique_ptr<NodeBase> (*)();
+
+    namespace Implement
+    {
+        struct World final
+        {
+            std::uint64_t now_ns{start_ns};
+            bool is_shutdown{false};
+
+            std::map<std::string, std::vector<std::weak_ptr<Subscription>>> subscriptions{};
+            std::map<std::string, std::vector<std::weak_ptr<const Advertisement>>> advertisements{};
+            std::deque<std::pair<std::weak_ptr<Subscription>, std::shared_ptr<const void>>> pending{};
+
+            std::vector<std::weak_ptr<TimerEntry>> timers{};
+            std::uint64_t timer_order{0};
+
+            std::map<std::string, std::string> params{};
+            std::vector<std::pair<std::string, NodeFactory>> node_factories{};
+            std::string current_node{};
+
+            std::uint64_t delivered_count{0};
+            std::uint64_t timer_fired_count{0};
+        };
+
+        inline World& world() noexcept
+        {
+            static World instance{};
+            return instance;
+        }
+    }
+
+    inline std::uint64_t now_ns() noexcept
+    {
+        return Implement::world().now_ns;
+    }
+
+    inline bool is_shutdown() noexcept
+    {
+        return Implement::world().is_shutdown;
+    }
+
+    inline void shutdown() noexcept
+    {
+        Implement::world().is_shutdown = true;
+    }
+
+    inline const std::string& current_node() noexcept
+    {
+        return Implement::world().current_node;
+    }
+
+    // この間に作られたSubscriberやTimerのコールバックは、このノードの中で呼ばれたことにする(ログとthis_node::getName用)。
+    class NodeScope final
+    {
+        std::string saved;
+
+    public:
+        NodeScope(const std::string& node) noexcept:
+            saved{std::exchange(Implement::world().current_node, node)}
+        {}
+
+        ~NodeScope() noexcept
+        {
+            Implement::world().current_node = std::move(saved);
+        }
+
+        NodeScope(const NodeScope&) = delete;
+        NodeScope& operator=(const NodeScope&) = delete;
+    };
+
+    inline void log(const char *const level, const char *const format, ...) noexcept __attribute__((format(printf, 2, 3)));
+    inline void log(const char *const level, const char *const format, ...) noexcept
+    {
+        const auto& world = Implement::world();
+        std::fprintf(stderr, "[%5s] [%10.6f] [%s]: ", level, (world.now_ns - start_ns) * 1e-9, world.current_node.empty() ? "sim" : world.current_node.c_str());
+
+        std::va_list args;
+        va_start(args, format);
+        std::vfprintf(stderr, format, args);
+        va_end(args);
+
+        std::fputc('\n', stderr);
+    }
+
+    inline void set_param(const std::string& name, const std::string& value) noexcept
+    {
+        Implement::world().params[name] = value;
+    }
+
+    inline const std::string * get_param(const std::string& name) noexcept
+    {
+        const auto& params = Implement::world().params;
+        const auto it = params.find(name);
+        return (it != params.end()) ? &it->second : nullptr;
+    }
+
+    // トピック
+
+    namespace Implement
+    {
+        template<class F>
+        inline void for_each_advertisement(const std::string& topic, const F& f) noexcept
+        {
+            auto& advertisements = world().advertisements;
+            const auto it = advertisements.find(topic);
+            if(it == advertisements.end()) return;
+
+            // コールバックの中でadvertiseされてもいいように写してから回す。
+            const auto copied = it->second;
+            for(const auto& weak_advertisement : copied)
+            {
+                if(const auto advertisement = weak_advertisement.lock()) f(*advertisement);
+            }
+        }
+    }
+
+    inline std::shared_ptr<const Advertisement> advertise(Advertisement advertisement) noexcept
+    {
+        auto& world = Implement::world();
+        const auto ret = std::make_shared<const Advertisement>(std::move(advertisement));
+        world.advertisements[ret->topic].push_back(ret);
+
+        if(ret->on_connect)
+        {
+            if(const auto it = world.subscriptions.find(ret->topic); it != world.subscriptions.end())
+            {
+                for(const auto& weak_subscription : it->second)
+                {
+                    if(const auto subscription = weak_subscription.lock()) ret->on_connect(subscription->node);
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    inline std::shared_ptr<Subscription> subscribe(const std::string& topic, const std::type_index type, std::function<void(const std::shared_ptr<const void>&)> callback) noexcept
+    {
+        auto& world = Implement::world();
+        std::shared_ptr<Subscription> subscription
+        {
+            new Subscription{topic, type, world.current_node, std::move(callback)},
+            [](Subscription *const p) noexcept
+            {
+                Implement::for_each_advertisement(p->topic, [p](const Advertisement& advertisement) { if(advertisement.on_disconnect) advertisement.on_disconnect(p->node); });
+                delete p;
+            }
+        };
+        world.subscriptions[topic].push_back(subscription);
+
+        Implement::for_each_advertisement(topic, [&subscription](const Advertisement& advertisement) { if(advertisement.on_connect) advertisement.on_connect(subscription->node); });
+
+        return subscription;
+    }
+
+    inline std::uint32_t get_num_subscribers(const std::string& topic) noexcept
+    {
+        auto& world = Implement::world();
+        const auto it = world.subscriptions.find(topic);
+        if(it == world.subscriptions.end()) return 0;
+
+        std::uint32_t count = 0;
+        for(const auto& subscription : it->second)
+        {
+            if(!subscription.expired()) ++count;
+        }
+        return count;
+    }
+
+    inline void publish(const std::string& topic, const std::type_index type, const std::shared_ptr<const void>& msg_p) noexcept
+    {
+        auto& world = Implement::world();
+        const auto it = world.subscriptions.find(topic);
+        if(it == world.subscriptions.end()) return;
+
+        auto& subscriptions = it->second;
+        for(std::size_t i = 0; i < subscriptions.size();)
+        {
+            const auto subscription = subscriptions[i].lock();
+            if(!subscription)
+            {
+                subscriptions[i] = std::move(subscriptions.back());
+                subscriptions.pop_back();
+                continue;
+            }
+
+            if(subscription->type != type)
+            {
+                log("ERROR", "topic %s: type mismatch between publisher and subscriber.", topic.c_str());
+            }
+            else
+            {
+                world.pending.emplace_back(subscription, msg_p);
+            }
+            ++i;
+        }
+    }
+
+    // 溜まっているメッセージを全部配る。配った先でpublishされたものも配る。
+    inline void deliver_pending() noexcept
+    {
+        auto& world = Implement::world();
+        while(!world.pending.empty())
+        {
+            auto [weak_subscription, msg_p] = std::move(world.pending.front());
+            world.pending.pop_front();
+
+            if(const auto subscription = weak_subscription.lock())
+            {
+                const NodeScope scope{subscription->node};
+                subscription->callback(msg_p);
+                ++world.delivered_count;
+            }
+        }
+    }
+
+    // タイマー
+
+    inline std::shared_ptr<TimerEntry> create_timer(const double period, std::function<void(std::uint64_t, std::uint64_t, std::uint64_t)> callback, const bool is_oneshot, const bool is_running) noexcept
+    {
+        auto& world = Implement::world();
+        const std::uint64_t period_ns = (period > 0) ? static_cast<std::uint64_t>(period * 1e9 + 0.5) : 1;
+
+        auto timer = std::make_shared<TimerEntry>();
+        timer->period_ns = period_ns;
+        timer->next_ns = world.now_ns + period_ns;
+        timer->last_expected_ns = world.now_ns;
+        timer->last_real_ns = world.now_ns;
+        timer->order = world.timer_order++;
+        timer->node = world.current_node;
+        timer->is_oneshot = is_oneshot;
+        timer->is_running = is_running;
+        timer->callback = std::move(callback);
+
+        world.timers.push_back(timer);
+        return timer;
+    }
+
+    // 次に呼ばれるタイマーの予定時刻。なければuint64_tの最大値。
+    inline std::uint64_t next_timer_ns() noexcept
+    {
+        std::uint64_t ret = ~std::uint64_t{0};
+        for(const auto& weak_timer : Implement::world().timers)
+        {
+            const auto timer = weak_timer.lock();
+            if(timer && timer->is_running && timer->next_ns < ret) ret = timer->next_ns;
+        }
+        return ret;
+    }
+
+    // 次のタイマーの時刻まで時計を進めて、その時刻のタイマーを全部呼ぶ。タイマーがなければfalse。
+    inline bool step() noexcept
+    {
+        auto& world = Implement::world();
+        deliver_pending();
+
+        std::shared_ptr<TimerEntry> next{};
+        for(std::size_t i = 0; i < world.timers.size();)
+        {
+            auto timer = world.timers[i].lock();
+            if(!timer)
+            {
+                world.timers[i] = std::move(world.timers.back());
+                world.timers.pop_back();
+                continue;
+            }
+
+            if(timer->is_running && (!next || timer->next_ns < next->next_ns || (timer->next_ns == next->next_ns && timer->order < next->order)))
+            {
+                next = std::move(timer);
+            }
+            ++i;
+        }
+
+        if(!next) return false;
+
+        if(next->next_ns > world.now_ns) world.now_ns = next->next_ns;
+
+        const std::uint64_t expected_ns = next->next_ns;
+        const std::uint64_t last_expected_ns = next->last_expected_ns;
+        const std::uint64_t last_real_ns = next->last_real_ns;
+
+        next->last_expected_ns = expected_ns;
+        next->last_real_ns = world.now_ns;
+        next->next_ns += next->period_ns;
+        if(next->is_oneshot) next->is_running = false;
+
+        {
+            const NodeScope scope{next->node};
+            next->callback(expected_ns, last_expected_ns, last_real_ns);
+            ++world.timer_fired_count;
+        }
+
+        deliver_pending();
+        return true;
+    }
+
+    // end_nsより前のタイマーを全部呼んで、時計をend_nsまで進める。
+    inline void run_until(const std::uint64_t end_ns) noexcept
+    {
+        auto& world = Implement::world();
+        while(!world.is_shutdown && next_timer_ns() <= end_ns && step());
+
+        if(!world.is_shutdown && world.now_ns < end_ns) world.now_ns = end_ns;
+    }
+
+    // ノード
+
+    inline bool register_node(const char *const name, const NodeFactory factory) noexcept
+    {
+        Implement::world().node_factories.emplace_back(name, factory);
+        return true;
+    }
+
+    inline const std::vector<std::pair<std::string, NodeFactory>>& get_node_factories() noexcept
+    {
+        return Implement::world().node_factories;
+    }
+
+    inline std::uint64_t get_delivered_count() noexcept
+    {
+        return Implement::world().delivered_count;
+    }
+
+    inline std::uint64_t get_timer_fired_count() noexcept
+    {
+        return Implement::world().timer_fired_count;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ros.h"
+
+namespace ros
+{
+    // コールバックはworld.hppのキューで配るので、呼ばれたら溜まっている分を配るだけ。
+    class CallbackQueue final
+    {
+    public:
+        void callAvailable(const Duration& = {}) noexcept
+        {
+            ::Harurobo2022::Sim::deliver_pending();
+        }
+    };
+
+    inline CallbackQueue * getGlobalCallbackQueue() noexcept
+    {
+        static CallbackQueue queue{};
+        return &queue;
+    }
+}
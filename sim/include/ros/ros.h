@@ -0,0 +1,397 @@
+/*
+
+シミュレーション用のros/ros.h。ノードとラッパーが使っている分だけを、harurobo2022_sim/world.hppの上に作ったもの。
+本物のroscppとは一緒に使えない。HARUROBO2022_SIMでビルドするときだけインクルードパスに入れる。
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <functional>
+#include <memory>
+#include <typeindex>
+#include <type_traits>
+#include <utility>
+
+#include <boost/shared_ptr.hpp>
+
+#include "harurobo2022_sim/world.hpp"
+
+#define ROS_DEBUG(...) do{}while(0)
+#define ROS_INFO(...) ::Harurobo2022::Sim::log("INFO", __VA_ARGS__)
+#define ROS_WARN(...) ::Harurobo2022::Sim::log("WARN", __VA_ARGS__)
+#define ROS_ERROR(...) ::Harurobo2022::Sim::log("ERROR", __VA_ARGS__)
+#define ROS_FATAL(...) ::Harurobo2022::Sim::log("FATAL", __VA_ARGS__)
+
+namespace ros
+{
+    class Duration final
+    {
+        std::int64_t nsec_{0};
+
+    public:
+        Duration() = default;
+
+        Duration(const double sec) noexcept:
+            nsec_{static_cast<std::int64_t>(std::llround(sec * 1e9))}
+        {}
+
+        static Duration fromNSec(const std::int64_t nsec) noexcept
+        {
+            Duration ret;
+            ret.nsec_ = nsec;
+            return ret;
+        }
+
+        double toSec() const noexcept
+        {
+            return nsec_ * 1e-9;
+        }
+
+        std::int64_t toNSec() const noexcept
+        {
+            return nsec_;
+        }
+    };
+
+    class Time final
+    {
+    public:
+        std::uint32_t sec{0};
+        std::uint32_t nsec{0};
+
+        Time() = default;
+
+        Time(const std::uint32_t sec, const std::uint32_t nsec) noexcept:
+            sec{sec},
+            nsec{nsec}
+        {}
+
+        static Time now() noexcept
+        {
+            Time ret;
+            ret.fromNSec(::Harurobo2022::Sim::now_ns());
+            return ret;
+        }
+
+        Time& fromNSec(const std::uint64_t t) noexcept
+        {
+            sec = t / 1'000'000'000;
+            nsec = t % 1'000'000'000;
+            return *this;
+        }
+
+        std::uint64_t toNSec() const noexcept
+        {
+            return std::uint64_t{sec} * 1'000'000'000 + nsec;
+        }
+
+        double toSec() const noexcept
+        {
+            return sec + nsec * 1e-9;
+        }
+
+        bool isZero() const noexcept
+        {
+            return !sec && !nsec;
+        }
+
+        Duration operator-(const Time& other) const noexcept
+        {
+            return Duration::fromNSec(static_cast<std::int64_t>(toNSec()) - static_cast<std::int64_t>(other.toNSec()));
+        }
+
+        Time operator-(const Duration& duration) const noexcept
+        {
+            Time ret;
+            ret.fromNSec(toNSec() - duration.toNSec());
+            return ret;
+        }
+
+        Time operator+(const Duration& duration) const noexcept
+        {
+            Time ret;
+            ret.fromNSec(toNSec() + duration.toNSec());
+            return ret;
+        }
+
+        bool operator<(const Time& other) const noexcept
+        {
+            return toNSec() < other.toNSec();
+        }
+
+        bool operator==(const Time& other) const noexcept
+        {
+            return toNSec() == other.toNSec();
+        }
+    };
+
+    struct TimerEvent final
+    {
+        Time last_expected;
+        Time last_real;
+        Time current_expected;
+        Time current_real;
+    };
+
+    class Timer final
+    {
+        std::shared_ptr<::Harurobo2022::Sim::TimerEntry> entry{};
+
+    public:
+        Timer() = default;
+
+        explicit Timer(std::shared_ptr<::Harurobo2022::Sim::TimerEntry> entry) noexcept:
+            entry{std::move(entry)}
+        {}
+
+        void start() noexcept
+        {
+            if(entry && !entry->is_running)
+            {
+                entry->is_running = true;
+                entry->next_ns = ::Harurobo2022::Sim::now_ns() + entry->period_ns;
+            }
+        }
+
+        void stop() noexcept
+        {
+            if(entry) entry->is_running = false;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return static_cast<bool>(entry);
+        }
+    };
+
+    class SingleSubscriberPublisher final
+    {
+        std::string topic;
+        std::string subscriber_name;
+
+    public:
+        SingleSubscriberPublisher(std::string topic, std::string subscriber_name) noexcept:
+            topic{std::move(topic)},
+            subscriber_name{std::move(subscriber_name)}
+        {}
+
+        const std::string& getTopic() const noexcept
+        {
+            return topic;
+        }
+
+        const std::string& getSubscriberName() const noexcept
+        {
+            return subscriber_name;
+        }
+    };
+
+    using SubscriberStatusCallback = std::function<void(const SingleSubscriberPublisher&)>;
+
+    class Publisher final
+    {
+        std::shared_ptr<const ::Harurobo2022::Sim::Advertisement> advertisement{};
+
+    public:
+        Publisher() = default;
+
+        explicit Publisher(std::shared_ptr<const ::Harurobo2022::Sim::Advertisement> advertisement) noexcept:
+            advertisement{std::move(advertisement)}
+        {}
+
+        template<class M>
+        void publish(const M& msg) const noexcept
+        {
+            if(advertisement && getNumSubscribers())
+            {
+                ::Harurobo2022::Sim::publish(advertisement->topic, typeid(M), std::make_shared<const M>(msg));
+            }
+        }
+
+        template<class M>
+        void publish(const boost::shared_ptr<const M>& msg_p) const noexcept
+        {
+            if(advertisement) ::Harurobo2022::Sim::publish(advertisement->topic, typeid(M), msg_p);
+        }
+
+        std::uint32_t getNumSubscribers() const noexcept
+        {
+            return advertisement ? ::Harurobo2022::Sim::get_num_subscribers(advertisement->topic) : 0;
+        }
+
+        std::string getTopic() const noexcept
+        {
+            return advertisement ? advertisement->topic : std::string{};
+        }
+
+        void shutdown() noexcept
+        {
+            advertisement.reset();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return static_cast<bool>(advertisement);
+        }
+    };
+
+    class Subscriber final
+    {
+        std::shared_ptr<::Harurobo2022::Sim::Subscription> subscription{};
+
+    public:
+        Subscriber() = default;
+
+        explicit Subscriber(std::shared_ptr<::Harurobo2022::Sim::Subscription> subscription) noexcept:
+            subscription{std::move(subscription)}
+        {}
+
+        std::string getTopic() const noexcept
+        {
+            return subscription ? subscription->topic : std::string{};
+        }
+
+        void shutdown() noexcept
+        {
+            subscription.reset();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return static_cast<bool>(subscription);
+        }
+    };
+
+    class NodeHandle final
+    {
+    public:
+        NodeHandle(const std::string& = {}) noexcept
+        {}
+
+        template<class M>
+        Publisher advertise(const std::string& topic, std::uint32_t, bool = false) const noexcept
+        {
+            return Publisher{::Harurobo2022::Sim::advertise({topic, typeid(M)})};
+        }
+
+        template<class M>
+        Publisher advertise(const std::string& topic, std::uint32_t, const SubscriberStatusCallback& connect_cb, const SubscriberStatusCallback& disconnect_cb = {}) const noexcept
+        {
+            const auto wrap = [topic](const SubscriberStatusCallback& callback)
+            {
+                return callback ? std::function<void(const std::string&)>{[topic, callback](const std::string& node) { callback(SingleSubscriberPublisher{topic, "/" + node}); }} : nullptr;
+            };
+
+            return Publisher{::Harurobo2022::Sim::advertise({topic, typeid(M), wrap(connect_cb), wrap(disconnect_cb)})};
+        }
+
+        template<class M, class F>
+        Subscriber subscribe(const std::string& topic, std::uint32_t, const F& callback) const noexcept
+        {
+            return Subscriber
+            {
+                ::Harurobo2022::Sim::subscribe
+                (
+                    topic, typeid(M),
+                    [callback](const std::shared_ptr<const void>& msg_p)
+                    {
+                        callback(std::static_pointer_cast<const M>(msg_p));
+                    }
+                )
+            };
+        }
+
+        template<class M, class T>
+        Subscriber subscribe(const std::string& topic, const std::uint32_t queue_size, void (T::*const callback)(const boost::shared_ptr<const M>&), T *const obj) const noexcept
+        {
+            return subscribe<M>(topic, queue_size, [callback, obj](const boost::shared_ptr<const M>& msg_p) { (obj->*callback)(msg_p); });
+        }
+
+        template<class F, std::enable_if_t<std::is_invocable_v<const F&, const TimerEvent&>, std::nullptr_t> = nullptr>
+        Timer createTimer(const Duration& period, const F& callback, const bool oneshot = false, const bool autostart = true) const noexcept
+        {
+            return Timer
+            {
+                ::Harurobo2022::Sim::create_timer
+                (
+                    period.toSec(),
+                    [callback](const std::uint64_t expected_ns, const std::uint64_t last_expected_ns, const std::uint64_t last_real_ns)
+                    {
+                        TimerEvent event;
+                        event.current_expected.fromNSec(expected_ns);
+                        event.current_real = Time::now();
+                        event.last_expected.fromNSec(last_expected_ns);
+                        event.last_real.fromNSec(last_real_ns);
+                        callback(event);
+                    },
+                    oneshot, autostart
+                )
+            };
+        }
+
+        template<class T>
+        Timer createTimer(const Duration& period, void (T::*const callback)(const TimerEvent&), T *const obj, const bool oneshot = false, const bool autostart = true) const noexcept
+        {
+            return createTimer(period, [callback, obj](const TimerEvent& event) { (obj->*callback)(event); }, oneshot, autostart);
+        }
+    };
+
+    inline void init(int&, char **, const std::string&) noexcept
+    {}
+
+    inline bool ok() noexcept
+    {
+        return !::Harurobo2022::Sim::is_shutdown();
+    }
+
+    inline void shutdown() noexcept
+    {
+        ::Harurobo2022::Sim::shutdown();
+    }
+
+    inline void spinOnce() noexcept
+    {
+        ::Harurobo2022::Sim::deliver_pending();
+    }
+
+    inline void spin() noexcept
+    {
+        while(ok() && ::Harurobo2022::Sim::step());
+    }
+
+    namespace param
+    {
+        inline bool get(const std::string& name, std::string& value) noexcept
+        {
+            if(const std::string *const p = ::Harurobo2022::Sim::get_param(name))
+            {
+                value = *p;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    namespace this_node
+    {
+        inline std::string getName() noexcept
+        {
+            return "/" + ::Harurobo2022::Sim::current_node();
+        }
+    }
+
+    namespace message_traits
+    {
+        template<class M, class = void>
+        struct IsMessage : std::false_type
+        {};
+
+        template<class M>
+        struct IsMessage<M, std::void_t<typename M::ConstPtr>> : std::true_type
+        {};
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+
+// 生成されたメッセージのヘッダの代わりを書くためのもの。
+#define HARUROBO2022_SIM_MESSAGE(Name) \
+    using Ptr = boost::shared_ptr<Name>; \
+    using ConstPtr = boost::shared_ptr<const Name>;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ros/sim_message.h>
+
+namespace std_msgs
+{
+    struct Bool
+    {
+        using _data_type = std::uint8_t;
+        _data_type data{};
+
+        HARUROBO2022_SIM_MESSAGE(Bool)
+    };
+
+    using BoolConstPtr = Bool::ConstPtr;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <ros/sim_message.h>
+
+namespace std_msgs
+{
+    struct Empty
+    {
+        HARUROBO2022_SIM_MESSAGE(Empty)
+    };
+
+    using EmptyConstPtr = Empty::ConstPtr;
+}
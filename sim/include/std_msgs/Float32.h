@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ros/sim_message.h>
+
+namespace std_msgs
+{
+    struct Float32
+    {
+        using _data_type = float;
+        _data_type data{};
+
+        HARUROBO2022_SIM_MESSAGE(Float32)
+    };
+
+    using Float32ConstPtr = Float32::ConstPtr;
+}
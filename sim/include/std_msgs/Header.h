@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <ros/ros.h>
+#include <ros/sim_message.h>
+
+namespace std_msgs
+{
+    struct Header
+    {
+        std::uint32_t seq{};
+        ros::Time stamp{};
+        std::string frame_id{};
+
+        HARUROBO2022_SIM_MESSAGE(Header)
+    };
+}
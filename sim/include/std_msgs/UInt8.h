@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ros/sim_message.h>
+
+namespace std_msgs
+{
+    struct UInt8
+    {
+        using _data_type = std::uint8_t;
+        _data_type data{};
+
+        HARUROBO2022_SIM_MESSAGE(UInt8)
+    };
+
+    using UInt8ConstPtr = UInt8::ConstPtr;
+}
@@ -0,0 +1,174 @@
+/*
+
+シミュレーション用の機体。運動学だけで、滑りも質量も考えない。
+
+・can_txから足回りのshirasuへのフレームを拾う(実機でslcan_bridgeが読むのと同じ)。
+  cmdでvelocity_modeになっているモーターだけ、targetの角速度[rad/s]に時定数wheel_tauの一次遅れで追従する。
+・ホイールの角速度から機体の速度を出し(OmniKinematics::forward)、積分して位置と姿勢にする。
+・odometry_periodごとに、odometryのCANフレーム(RawDataをそのまま8バイトずつ)をcan_rxに流す。
+  中身はauto_commanderに合わせて初期位置からの差。
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include <ros/ros.h>
+#include <can_plugins/Frame.h>
+#include <harurobo2022/Odometry.h>
+
+#include "harurobo2022/lib/vec2d.hpp"
+#include "harurobo2022/lib/omni_kinematics.hpp"
+#include "harurobo2022/lib/can_codec.hpp"
+#include "harurobo2022/shirasu_util.hpp"
+#include "harurobo2022/config.hpp"
+#include "harurobo2022/message_convertor/harurobo2022/Odometry.hpp"
+
+namespace Harurobo2022
+{
+    namespace
+    {
+        class Plant final
+        {
+        public:
+            struct Parameter final
+            {
+                double physics_period{0.0005};
+                double odometry_period{0.002};
+                double wheel_tau{0.02};
+            };
+
+            struct Pose final
+            {
+                StewLib::Vec2D<double> pos;
+                double rot_z;
+            };
+
+        private:
+            constexpr static std::size_t wheel_size = 4;
+
+            const Parameter param;
+
+            ros::NodeHandle nh{};
+            ros::Publisher can_rx_pub{nh.advertise<can_plugins::Frame>("can_rx", 1000)};
+            ros::Subscriber can_tx_sub{nh.subscribe<can_plugins::Frame>("can_tx", 1000, [this](const can_plugins::Frame::ConstPtr& msg_p) { on_frame(*msg_p); })};
+            ros::Timer physics_timer{nh.createTimer(ros::Duration(param.physics_period), [this](const ros::TimerEvent&) { step(); })};
+            ros::Timer odometry_timer{nh.createTimer(ros::Duration(param.odometry_period), [this](const ros::TimerEvent&) { publish_odometry(); })};
+
+            std::uint8_t modes[wheel_size]{};
+            double targets[wheel_size]{};
+            double wheels_vela[wheel_size]{};
+
+            Pose pose{Config::InitialState::position, Config::InitialState::rot_z};
+            double distance{0};
+            double max_vell{0};
+            std::uint64_t frame_count{0};
+
+        public:
+            Plant(const Parameter& param) noexcept:
+                param{param}
+            {}
+
+            const Pose& get_pose() const noexcept
+            {
+                return pose;
+            }
+
+            double get_distance() const noexcept
+            {
+                return distance;
+            }
+
+            double get_max_vell() const noexcept
+            {
+                return max_vell;
+            }
+
+            std::uint64_t get_frame_count() const noexcept
+            {
+                return frame_count;
+            }
+
+        private:
+            void on_frame(const can_plugins::Frame& frame) noexcept
+            {
+                ++frame_count;
+
+                for(std::size_t i = 0; i < wheel_size; ++i)
+                {
+                    const std::uint16_t bid = Config::CanId::Tx::DriveMotor::all[i];
+
+                    if(frame.id == bid && frame.dlc == 1)
+                    {
+                        modes[i] = frame.data[0];
+                    }
+                    else if(frame.id == ShirasuUtil::target_id(bid) && frame.dlc == sizeof(float))
+                    {
+                        // targetは上位バイトから送られてくる。
+                        StewLib::BigEndian<float> buffer{};
+                        std::memcpy(buffer.bytes, frame.data.data(), sizeof(float));
+                        targets[i] = buffer;
+                    }
+                }
+            }
+
+            void step() noexcept
+            {
+                using namespace Config::Wheel;
+                static constexpr StewLib::OmniKinematics<wheel_size> kinematics{Pos::all, Direction::all, Config::wheel_radius};
+
+                const double dt = param.physics_period;
+                const double gain = 1 - std::exp(-dt / param.wheel_tau);
+
+                for(std::size_t i = 0; i < wheel_size; ++i)
+                {
+                    const double target = (modes[i] == ShirasuUtil::velocity_mode) ? targets[i] : 0;
+                    wheels_vela[i] += (target - wheels_vela[i]) * gain;
+                }
+
+                const auto twist = kinematics.forward(wheels_vela);
+                const auto vell_global = StewLib::rot(twist.vell, pose.rot_z);
+
+                pose.pos = pose.pos + vell_global * dt;
+                pose.rot_z += twist.vela * dt;
+
+                const double speed = +vell_global;
+                distance += speed * dt;
+                max_vell = std::max(max_vell, speed);
+            }
+
+            void publish_odometry() noexcept
+            {
+                using RawData = MessageConvertor<harurobo2022::Odometry>::RawData;
+
+                const RawData raw_data
+                {
+                    static_cast<float>(pose.pos.x - Config::InitialState::position.x),
+                    static_cast<float>(pose.pos.y - Config::InitialState::position.y),
+                    static_cast<float>(pose.rot_z - Config::InitialState::rot_z)
+                };
+
+                std::uint8_t bytes[sizeof(RawData)];
+                std::memcpy(bytes, &raw_data, sizeof(RawData));
+
+                // 実機ではslcan_bridgeが受け取った時刻を入れてくる。
+                const ros::Time stamp = ros::Time::now();
+
+                for(std::size_t offset = 0; offset < sizeof(RawData); offset += 8)
+                {
+                    can_plugins::Frame frame{};
+                    frame.header.stamp = stamp;
+                    frame.id = Config::CanId::Rx::odometry;
+                    frame.dlc = std::min<std::size_t>(8, sizeof(RawData) - offset);
+                    std::memcpy(frame.data.data(), bytes + offset, frame.dlc);
+                    can_rx_pub.publish(frame);
+                }
+            }
+        };
+    }
+}
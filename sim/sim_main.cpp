@@ -0,0 +1,169 @@
+/*
+
+ROSなしで制御系を丸ごと回すシミュレータ。
+
+can_subscriber, state_manager, under_carriage_4wheel, auto_commanderをHARUROBO2022_SIMでビルドして一つのプロセスに読み込み、
+Plant(plant.hpp)をCANの向こう側に置く。時計はシミュレーション時間なので、実時間より速く回る。
+状態をReset -> Automaticにしてチャートを走らせ、game_clear(auto_commanderがros::shutdownを呼ぶ)かtimeoutで止める。
+
+使い方:
+    harurobo2022_sim [--chart path] [--timeout 秒] [--odometry-period 秒] [--record path] [--mirror mode]
+
+--chartを渡さなければsim/chart.csv(HARUROBO2022_SIM_CHART)。本番のチャート(others/)とは別に持つ。
+--chart ""ならビルド時のチャート(StaticChart::chart1)。
+--recordを渡すとcan_recorderも動かしてCANのログを書く(harurobo2022_can_replayで流しなおせる)。
+--mirrorは全ノードの~debug_mirror(debug_mirror.hpp)。FR_drive_targetを購読して、流れてきた数を出す。
+終わったらかかった時間(シミュレーションと実時間)、コールバックの回数、最後の姿勢を出す。
+各ノードのコールバックの実行時間はProfilerがConfig::Profiling::dump_dirに書き出す。
+
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <std_msgs/Float32.h>
+#include <std_msgs/UInt8.h>
+
+#include "harurobo2022/state.hpp"
+#include "harurobo2022/stringlike_types.hpp"
+
+#include "plant.hpp"
+
+using namespace Harurobo2022;
+
+namespace
+{
+    struct Option final
+    {
+        const char * chart_path{HARUROBO2022_SIM_CHART};
+        const char * record_path{nullptr};
+        const char * mirror_mode{nullptr};
+        double timeout{120};
+        Plant::Parameter plant{};
+    };
+
+    bool parse(const int argc, char ** argv, Option& option) noexcept
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            const bool has_value = i + 1 < argc;
+
+            if(!std::strcmp(argv[i], "--chart") && has_value) option.chart_path = argv[++i];
+            else if(!std::strcmp(argv[i], "--timeout") && has_value) option.timeout = std::atof(argv[++i]);
+            else if(!std::strcmp(argv[i], "--record") && has_value) option.record_path = argv[++i];
+            else if(!std::strcmp(argv[i], "--mirror") && has_value) option.mirror_mode = argv[++i];
+            else if(!std::strcmp(argv[i], "--odometry-period") && has_value) option.plant.odometry_period = std::atof(argv[++i]);
+            else return false;
+        }
+
+        return true;
+    }
+
+    double cpu_seconds() noexcept
+    {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    void set_state(const ros::Publisher& state_pub, const State state) noexcept
+    {
+        std_msgs::UInt8 msg;
+        msg.data = static_cast<std::uint8_t>(state);
+        state_pub.publish(msg);
+        Sim::deliver_pending();
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    Option option{};
+    if(!parse(argc, argv, option))
+    {
+        std::fprintf(stderr, "usage: %s [--chart path] [--timeout sec] [--odometry-period sec] [--record path] [--mirror mode]\n", argv[0]);
+        return 2;
+    }
+
+    if(option.chart_path && *option.chart_path)
+    {
+        Sim::set_param(std::string("/") + StringlikeTypes::auto_commander::str + "/chart_path", option.chart_path);
+    }
+
+    if(option.record_path)
+    {
+        Sim::set_param(std::string("/") + StringlikeTypes::can_recorder::str + "/path", option.record_path);
+    }
+
+    if(option.mirror_mode)
+    {
+        for(const auto& [name, factory] : Sim::get_node_factories())
+        {
+            Sim::set_param("/" + name + "/debug_mirror", option.mirror_mode);
+        }
+    }
+
+    ros::NodeHandle nh{};
+    const ros::Publisher state_pub = nh.advertise<std_msgs::UInt8>(StringlikeTypes::state::str, 10);
+
+    State last_state{State::disable};
+    const ros::Subscriber state_sub = nh.subscribe<std_msgs::UInt8>
+    (
+        StringlikeTypes::state::str, 10,
+        [&last_state](const std_msgs::UInt8::ConstPtr& msg_p) { last_state = static_cast<State>(msg_p->data); }
+    );
+
+    std::uint64_t mirror_count = 0;
+    const ros::Subscriber mirror_sub = nh.subscribe<std_msgs::Float32>
+    (
+        "FR_drive_target", 10,
+        [&mirror_count](const std_msgs::Float32::ConstPtr&) { ++mirror_count; }
+    );
+
+    Plant plant{option.plant};
+
+    std::vector<std::unique_ptr<Sim::NodeBase>> nodes;
+    for(const auto& [name, factory] : Sim::get_node_factories())
+    {
+        if(name == StringlikeTypes::can_recorder::str && !option.record_path) continue;
+        nodes.push_back(factory());
+    }
+
+    const auto wall_start = std::chrono::steady_clock::now();
+    const double cpu_start = cpu_seconds();
+    const std::uint64_t sim_start = Sim::now_ns();
+
+    set_state(state_pub, State::reset);
+    set_state(state_pub, State::automatic);
+
+    Sim::run_until(sim_start + static_cast<std::uint64_t>(option.timeout * 1e9));
+
+    const double sim_time = (Sim::now_ns() - sim_start) * 1e-9;
+    const double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    const double cpu_time = cpu_seconds() - cpu_start;
+    const bool is_cleared = Sim::is_shutdown();
+
+    // ノードを壊すとProfilerの結果が書き出される。
+    nodes.clear();
+
+    const auto& pose = plant.get_pose();
+    std::printf("result:          %s\n", is_cleared ? "game_clear" : "timeout");
+    std::printf("last state:      %u\n", static_cast<unsigned int>(last_state));
+    std::printf("sim time:        %.3f s\n", sim_time);
+    std::printf("wall time:       %.3f s (x%.1f real time)\n", wall_time, (wall_time > 0) ? sim_time / wall_time : 0.0);
+    std::printf("cpu time:        %.3f s (%.2f us per sim ms)\n", cpu_time, (sim_time > 0) ? cpu_time * 1e3 / sim_time : 0.0);
+    std::printf("timer callbacks: %llu\n", static_cast<unsigned long long>(Sim::get_timer_fired_count()));
+    std::printf("messages:        %llu\n", static_cast<unsigned long long>(Sim::get_delivered_count()));
+    std::printf("can frames:      %llu\n", static_cast<unsigned long long>(plant.get_frame_count()));
+    std::printf("FR_drive_target: %llu\n", static_cast<unsigned long long>(mirror_count));
+    std::printf("final pose:      (%.2f, %.2f) mm, %.4f rad\n", pose.pos.x, pose.pos.y, pose.rot_z);
+    std::printf("distance:        %.1f mm, max speed %.1f mm/s\n", plant.get_distance(), plant.get_max_vell());
+
+    return is_cleared ? 0 : 1;
+}
@@ -2,10 +2,17 @@
 
 */
 
+#include <algorithm>
+#include <vector>
+#include <optional>
+#include <string>
+
 #include <std_msgs/UInt8.h>
 #include <harurobo2022/Twist.h>
 
 #include "harurobo2022/lib/pid_functor.hpp"
+#include "harurobo2022/lib/trapezoidal_path.hpp"
+#include "harurobo2022/lib/alpha_beta_filter.hpp"
 #include "harurobo2022/timer.hpp"
 #include "harurobo2022/state.hpp"
 #include "harurobo2022/can_publisher.hpp"
@@ -16,6 +23,14 @@
 #include "harurobo2022/topics/table_cloth.hpp"
 #include "harurobo2022/topics/odometry.hpp"
 #include "harurobo2022/chart.hpp"
+#include "harurobo2022/csv_parser.hpp"
+
+#ifdef HARUROBO2022_NODELET
+#include <pluginlib/class_list_macros.h>
+#include "harurobo2022/nodelet.hpp"
+#elif defined(HARUROBO2022_SIM)
+#include "harurobo2022/sim_node.hpp"
+#endif
 
 using namespace StewLib;
 using namespace Harurobo2022;
@@ -25,6 +40,8 @@ namespace
     class AutoCommanderNode final
     {
         ChartManager chart_manager;
+        // ~chart_pathで渡されたチャート。なければビルド時のもの(StaticChart::chart1)を使う。
+        std::optional<ChartFile> chart_file{};
 
         LiftMotors lift_motors{};
 
@@ -34,11 +51,9 @@ namespace
 
         CanPublisher<Topics::table_cloth_command> table_cloth_pub{1};
 
-        Subscriber<Topics::odometry_x> odometry_x_sub{1, [this](const typename Topics::odometry_x::Message::ConstPtr& msg_p) noexcept { odometry_x_callback(msg_p); }};
-        Subscriber<Topics::odometry_y> odometry_y_sub{1, [this](const typename Topics::odometry_y::Message::ConstPtr& msg_p) noexcept { odometry_y_callback(msg_p); }};
-        Subscriber<Topics::odometry_yaw> odometry_yaw_sub{1, [this](const typename Topics::odometry_yaw::Message::ConstPtr& msg_p) noexcept { odometry_yaw_callback(msg_p); }};
+        Subscriber<Topics::odometry> odometry_sub{1, [this](const typename Topics::odometry::Message::ConstPtr& msg_p) noexcept { odometry_callback(msg_p); }};
 
-        Timer timer{1.0 / Config::ExecutionInterval::auto_commander_freq, [this](const auto&){ timer_callback(); }};
+        Timer timer{1.0 / Config::ExecutionInterval::auto_commander_freq, [this](const auto&){ timer_callback(); }, "auto_commander/timer"};
 
         StateManager state_manager
         {
@@ -46,48 +61,132 @@ namespace
             {
                 if(state == State::reset)
                 {
-                    chart_manager.reset_chart();
+                    load_chart();
+                    plan_trajectory();
+                    position_pid.reset();
+                    rot_z_pid.reset();
+                    // 経路は今の推定位置から引いたので、そのあとで速度を捨てて次のオドメトリからやり直す。
+                    pos_estimator.reset();
+                    rot_z_estimator.reset();
                 }
             }
         };
 
-        // ひとまずは位置と姿勢を速度上限つきP制御で追う。目標位置姿勢と現在位置姿勢の差を定数倍して並進速度角速度にする。
+        // 位置は通過点を結んだ経路に台形の速度分布をつけて、その目標速度にPID(位置の差)を足して追う。
+        // 姿勢は目標と現在の差をPIDにかけるだけ。
+        // オドメトリはtimer_callbackと関係なく届くので、α-βフィルタで速度を推定し、周期の頭の時刻まで外挿して使う。
+        StewLib::AlphaBetaFilter<Vec2D<float>> pos_estimator{{Config::Estimator::alpha, Config::Estimator::beta, Config::Estimator::max_extrapolation}};
+        StewLib::AlphaBetaFilter<float> rot_z_estimator{{Config::Estimator::alpha, Config::Estimator::beta, Config::Estimator::max_extrapolation}};
+
         Vec2D<float> now_pos{};
         float now_rot_z{};
 
-        StewLib::Pid<StewLib::Vec2D<float>> position_pid{Config::Pid::position_k_p, Config::Pid::position_k_i, Config::Pid::position_k_d};
-        StewLib::Pid<float> rot_z_pid{Config::Pid::rot_z_k_p, Config::Pid::rot_z_k_i, Config::Pid::rot_z_k_d};
+        TrapezoidalPath trajectory{};
+        double trajectory_time{0};
+
+        // 出力の上限はConfig::Limitationに合わせる。張り付いている間は積分しない。
+        StewLib::DiscretePid<StewLib::Vec2D<float>> position_pid
+        {{
+            Config::Pid::position_k_p, Config::Pid::position_k_i, Config::Pid::position_k_d,
+            1.0 / Config::ExecutionInterval::auto_commander_freq, Config::Pid::position_derivative_tau, Config::Limitation::body_vell
+        }};
+        StewLib::DiscretePid<float> rot_z_pid
+        {{
+            Config::Pid::rot_z_k_p, Config::Pid::rot_z_k_i, Config::Pid::rot_z_k_d,
+            1.0 / Config::ExecutionInterval::auto_commander_freq, Config::Pid::rot_z_derivative_tau, Config::Limitation::body_vela
+        }};
 
     public:
-        AutoCommanderNode() = default;
+        AutoCommanderNode() noexcept
+        {
+            load_chart();
+            plan_trajectory();
+        }
 
     private:
-        void odometry_x_callback(const Topics::odometry_x::Message::ConstPtr& msg_p) noexcept
+        // 読めなかったら今のチャートのまま最初からやり直す。
+        void load_chart() noexcept
         {
-            now_pos.x = msg_p->data + Config::InitialState::position.x;
+            std::string path{};
+            ros::param::get(std::string("/") + StringlikeTypes::auto_commander::str + "/chart_path", path);
+
+            if(path.empty())
+            {
+                chart_file.reset();
+                chart_manager.change_chart(StaticChart::chart1);
+                return;
+            }
+
+            ChartError error{};
+            if(auto loaded = ChartFile::load(path.c_str(), error))
+            {
+                chart_file = std::move(loaded);
+                chart_manager.change_chart(chart_file->view());
+                ROS_INFO("%s: chart loaded from %s. %zu commands.", StringlikeTypes::auto_commander::str, path.c_str(), chart_manager.chart.size());
+            }
+            else
+            {
+                ROS_ERROR("%s: failed to load chart. %s:%zu:%zu: %s", StringlikeTypes::auto_commander::str, path.c_str(), error.line, error.column, error.what);
+                chart_manager.reset_chart();
+            }
         }
 
-        void odometry_y_callback(const Topics::odometry_y::Message::ConstPtr& msg_p) noexcept
+        // オドメトリが一度でも届いていれば今の推定位置から、まだなら初期位置から引く。
+        void plan_trajectory() noexcept
         {
-            now_pos.y = msg_p->data + Config::InitialState::position.y;
+            std::vector<TrapezoidalPath::Waypoint> waypoints;
+            for(const auto& command : chart_manager.chart)
+            {
+                if(command.work == Work::transit)
+                {
+                    waypoints.push_back({command.pass_near_circle.center, command.pass_near_circle.range});
+                }
+            }
+
+            Vec2D<float> start = Config::InitialState::position;
+            if(pos_estimator.has_measurement())
+            {
+                start = pos_estimator.position_at(ros::Time::now().toSec());
+            }
+
+            trajectory.plan(start, waypoints, Config::Limitation::body_vell, Config::Limitation::body_accl, Config::Pid::position_k_p);
+            trajectory_time = 0;
+
+            ROS_INFO("%s: trajectory planned. %zu waypoints, %.2f s.", StringlikeTypes::auto_commander::str, waypoints.size(), trajectory.get_total_time());
         }
 
-        void odometry_yaw_callback(const Topics::odometry_yaw::Message::ConstPtr& msg_p) noexcept
+        void odometry_callback(const Topics::odometry::Message::ConstPtr& msg_p) noexcept
         {
-            now_rot_z = msg_p->data + Config::InitialState::rot_z;
+            // stampはcan_subscriberが受け取った時刻。入っていなければ今。
+            const double stamp = (msg_p->header.stamp.isZero() ? ros::Time::now() : msg_p->header.stamp).toSec();
+
+            pos_estimator.update(Vec2D<float>(msg_p->pos_x, msg_p->pos_y) + Config::InitialState::position, stamp);
+            rot_z_estimator.update(msg_p->rot_z + Config::InitialState::rot_z, stamp);
         }
 
         void timer_callback() noexcept
         {
-            if(chart_manager.current_work->pass_near_circle.is_in(now_pos))
+            CanTxBatch can_tx_batch{};
+
+            if(pos_estimator.has_measurement())
+            {
+                const double now = ros::Time::now().toSec();
+                now_pos = pos_estimator.position_at(now);
+                now_rot_z = rot_z_estimator.position_at(now);
+            }
+
+            if(chart_manager.has_current_work() && chart_manager.get_current_work().pass_near_circle.is_in(now_pos))
             {
-                do_work(chart_manager.current_work->work);
+                do_work(chart_manager.get_current_work().work);
                 chart_manager.current_work_update();
             }
 
-            if(chart_manager.target_position->pass_near_circle.is_in(now_pos))
+            if(chart_manager.has_target_position() && chart_manager.get_target_position().pass_near_circle.is_in(now_pos))
             {
-                chart_manager.target_position_update();
+                if(const auto skipped = chart_manager.target_position_update(); skipped)
+                {
+                    ROS_WARN("%s: %zu works skipped.", StringlikeTypes::auto_commander::str, skipped);
+                }
             }
 
             auto twist = calc_twist();
@@ -189,11 +288,22 @@ namespace
 
         Topics::body_twist::MessageConvertor::RawData calc_twist() noexcept
         {
-            const auto target_pos = chart_manager.target_position->pass_near_circle.center;
-            const auto target_rot_z = chart_manager.current_work->target_rot_z;
+            const auto target_rot_z = chart_manager.get_current_work().target_rot_z;
+
+            const auto reference = trajectory.sample(trajectory_time);
+            const Vec2D<double> error = reference.pos - now_pos;
+
+            // 大きく遅れたら目標の時計を止めて待つ。
+            if(+error < Config::Trajectory::max_tracking_error)
+            {
+                trajectory_time += 1.0 / Config::ExecutionInterval::auto_commander_freq;
+            }
 
-            const auto linear_global = position_pid(target_pos - now_pos);
-            const auto angular = rot_z_pid(target_rot_z - now_rot_z);
+            // 目標速度と、推定速度とのずれに比例したものをフィードフォワードとして渡し、足したものを上限で縮める。
+            const Vec2D<double> velocity_error = reference.vel - pos_estimator.get_velocity();
+            const Vec2D<float> linear_global = position_pid(error, reference.vel + Config::Pid::velocity_k_p * velocity_error);
+
+            const float angular = rot_z_pid(target_rot_z - now_rot_z);
 
             const auto linear_onbody = rot(linear_global, -now_rot_z);
 
@@ -202,16 +312,35 @@ namespace
     };
 }
 
+#ifdef HARUROBO2022_NODELET
+
+namespace Harurobo2022Nodelets
+{
+    class AutoCommander final : public NodeletBase<AutoCommanderNode, StringlikeTypes::auto_commander>
+    {};
+}
+
+PLUGINLIB_EXPORT_CLASS(Harurobo2022Nodelets::AutoCommander, nodelet::Nodelet)
+
+#elif defined(HARUROBO2022_SIM)
+
+HARUROBO2022_SIM_EXPORT_NODE(AutoCommanderNode, StringlikeTypes::auto_commander)
+
+#else
+
 int main(int argc, char ** argv)
 {
     ros::init(argc, argv, StringlikeTypes::auto_commander::str);
     StaticInitDeinit satic_init_deinit;
 
+    RtExecutor rt_executor{Config::RtExecutor::Cpu::auto_commander};
     AutoCommanderNode auto_commander_node;
 
     ROS_INFO("%s node has started.", StringlikeTypes::auto_commander::str);
 
-    ros::spin();
+    rt_executor.spin();
 
     ROS_INFO("%s node has terminated.", StringlikeTypes::auto_commander::str);
-}
\ No newline at end of file
+}
+
+#endif
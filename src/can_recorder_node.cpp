@@ -0,0 +1,145 @@
+/*
+can_txとcan_rxのフレームを受け取った順にCanLogWriterで書き出すノード(can_log.hpp)。
+書き出し先はros paramの/can_recorder/path。なければConfig::CanLog::path。
+can_shm_bridge経由で送っているときも、ブリッジがcan_txに流したものを拾う。
+nodeletで同じマネージャに読み込めばシリアライズなしで記録できる。
+*/
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <ros/ros.h>
+#include <can_plugins/Frame.h>
+
+#include "harurobo2022/config.hpp"
+#include "harurobo2022/topic.hpp"
+#include "harurobo2022/subscriber.hpp"
+#include "harurobo2022/timer.hpp"
+#include "harurobo2022/stringlike_types.hpp"
+#include "harurobo2022/can_log.hpp"
+#include "harurobo2022/static_init_deinit.hpp"
+
+#ifdef HARUROBO2022_NODELET
+#include <pluginlib/class_list_macros.h>
+#include "harurobo2022/nodelet.hpp"
+#elif defined(HARUROBO2022_SIM)
+#include "harurobo2022/sim_node.hpp"
+#endif
+
+using namespace Harurobo2022;
+
+namespace
+{
+    class CanRecorderNode final
+    {
+        using can_tx = Topic<StringlikeTypes::can_tx, can_plugins::Frame>;
+        using can_rx = Topic<StringlikeTypes::can_rx, can_plugins::Frame>;
+
+        std::string path{load_path()};
+        std::optional<CanLogWriter> writer{CanLogWriter::create(path.c_str(), Config::CanLog::capacity)};
+
+        Subscriber<can_tx> can_tx_sub
+        {
+            1000,
+            [this](const can_tx::Message::ConstPtr& msg_p) noexcept
+            {
+                record(CanLogDirection::tx, *msg_p);
+            }
+        };
+
+        Subscriber<can_rx> can_rx_sub
+        {
+            1000,
+            [this](const can_rx::Message::ConstPtr& msg_p) noexcept
+            {
+                record(CanLogDirection::rx, *msg_p);
+            }
+        };
+
+        std::uint64_t reported_dropped{0};
+        Timer report_timer{1.0, [this](const ros::TimerEvent&) noexcept { report(); }, "can_recorder/report_timer"};
+
+    public:
+        CanRecorderNode() noexcept
+        {
+            if(writer) ROS_INFO("%s: recording to %s.", StringlikeTypes::can_recorder::str, path.c_str());
+            else ROS_ERROR("%s: failed to create %s.", StringlikeTypes::can_recorder::str, path.c_str());
+        }
+
+        ~CanRecorderNode() noexcept
+        {
+            if(!writer) return;
+
+            ROS_INFO
+            (
+                "%s: %lu frames written to %s (%lu dropped).",
+                StringlikeTypes::can_recorder::str, static_cast<unsigned long>(writer->size()), path.c_str(), static_cast<unsigned long>(writer->dropped())
+            );
+        }
+
+    private:
+        static std::string load_path() noexcept
+        {
+            std::string path{Config::CanLog::path};
+            ros::param::get(std::string("/") + StringlikeTypes::can_recorder::str + "/path", path);
+            return path;
+        }
+
+        // シミュレータでは実時間ではなくシミュレーションの時計で記録する(これも単調増加)。
+        static std::uint64_t stamp_ns() noexcept
+        {
+#ifdef HARUROBO2022_SIM
+            return ros::Time::now().toNSec();
+#else
+            return StewLib::monotonic_ns();
+#endif
+        }
+
+        void record(const CanLogDirection direction, const can_plugins::Frame& frame) noexcept
+        {
+            if(writer) writer->append({stamp_ns(), direction, frame});
+        }
+
+        void report() noexcept
+        {
+            if(writer && writer->dropped() != reported_dropped)
+            {
+                ROS_WARN("%s: log is full. %lu frames dropped in total.", StringlikeTypes::can_recorder::str, static_cast<unsigned long>(writer->dropped()));
+                reported_dropped = writer->dropped();
+            }
+        }
+    };
+}
+
+#ifdef HARUROBO2022_NODELET
+
+namespace Harurobo2022Nodelets
+{
+    class CanRecorder final : public NodeletBase<CanRecorderNode, StringlikeTypes::can_recorder>
+    {};
+}
+
+PLUGINLIB_EXPORT_CLASS(Harurobo2022Nodelets::CanRecorder, nodelet::Nodelet)
+
+#elif defined(HARUROBO2022_SIM)
+
+HARUROBO2022_SIM_EXPORT_NODE(CanRecorderNode, StringlikeTypes::can_recorder)
+
+#else
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, StringlikeTypes::can_recorder::str);
+    StaticInitDeinit static_init_deinit;
+
+    CanRecorderNode can_recorder_node;
+
+    ROS_INFO("%s node has started.", StringlikeTypes::can_recorder::str);
+
+    ros::spin();
+
+    ROS_INFO("%s node has terminated.", StringlikeTypes::can_recorder::str);
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+can_recorderが書いたログ(can_log.hpp)のcan_rxのフレームを、can_rxに流しなおすノード。can_subscriber以降を実機なしで動かす用。
+ros param:
+    /can_replayer/path      ログ。なければConfig::CanLog::path
+    /can_replayer/speed     1なら記録したときと同じ間隔、2なら倍速。0以下なら待たずに流す(Config::CanLog::replay_burstずつ)
+    /can_replayer/replay_tx trueならcan_txのフレームもcan_txに流す。実機のモーターが動くので気をつけること
+記録にあるheader.stampはそのまま付けて流す。流し終わったら止まる。
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <time.h>
+
+#include <ros/ros.h>
+#include <can_plugins/Frame.h>
+
+#include "harurobo2022/config.hpp"
+#include "harurobo2022/topic.hpp"
+#include "harurobo2022/publisher.hpp"
+#include "harurobo2022/stringlike_types.hpp"
+#include "harurobo2022/can_log.hpp"
+#include "harurobo2022/static_init_deinit.hpp"
+
+using namespace Harurobo2022;
+
+namespace
+{
+    class CanReplayerNode final
+    {
+        using can_tx = Topic<StringlikeTypes::can_tx, can_plugins::Frame>;
+        using can_rx = Topic<StringlikeTypes::can_rx, can_plugins::Frame>;
+
+        Publisher<can_tx> can_tx_pub{1000};
+        Publisher<can_rx> can_rx_pub{1000};
+
+        std::string path{Config::CanLog::path};
+        double speed{1};
+        bool replay_tx{false};
+
+        std::optional<CanLogReader> reader{};
+
+    public:
+        CanReplayerNode() noexcept
+        {
+            const std::string prefix = std::string("/") + StringlikeTypes::can_replayer::str;
+            ros::param::get(prefix + "/path", path);
+            ros::param::get(prefix + "/speed", speed);
+            ros::param::get(prefix + "/replay_tx", replay_tx);
+
+            const char * what = "";
+            reader = CanLogReader::open(path.c_str(), what);
+            if(!reader)
+            {
+                ROS_ERROR("%s: failed to open %s. %s", StringlikeTypes::can_replayer::str, path.c_str(), what);
+            }
+            else if(reader->dropped())
+            {
+                ROS_WARN("%s: %lu frames were dropped while recording.", StringlikeTypes::can_replayer::str, static_cast<unsigned long>(reader->dropped()));
+            }
+        }
+
+        bool is_open() const noexcept
+        {
+            return reader.has_value();
+        }
+
+        void run() noexcept
+        {
+            if(!reader || !reader->size()) return;
+
+            const std::uint64_t first_ns = (*reader)[0].stamp_ns;
+            const std::uint64_t start_ns = StewLib::monotonic_ns();
+
+            std::size_t published = 0;
+            std::size_t burst = 0;
+
+            for(const auto& record : *reader)
+            {
+                if(!ros::ok()) break;
+
+                if(speed > 0)
+                {
+                    sleep_until(start_ns + static_cast<std::uint64_t>((record.stamp_ns - first_ns) / speed));
+                }
+                else if(++burst == Config::CanLog::replay_burst)
+                {
+                    burst = 0;
+                    sleep_until(StewLib::monotonic_ns() + static_cast<std::uint64_t>(Config::CanLog::replay_burst_interval * 1e9));
+                }
+
+                if(record.direction == CanLogDirection::rx)
+                {
+                    can_rx_pub.publish(record.frame);
+                    ++published;
+                }
+                else if(replay_tx)
+                {
+                    can_tx_pub.publish(record.frame);
+                    ++published;
+                }
+            }
+
+            const double elapsed = (StewLib::monotonic_ns() - start_ns) * 1e-9;
+            const double recorded = ((*reader)[reader->size() - 1].stamp_ns - first_ns) * 1e-9;
+
+            ROS_INFO
+            (
+                "%s: %zu frames published in %.3lf s (recorded in %.3lf s).",
+                StringlikeTypes::can_replayer::str, published, elapsed, recorded
+            );
+        }
+
+    private:
+        static void sleep_until(const std::uint64_t target_ns) noexcept
+        {
+            const timespec ts{static_cast<time_t>(target_ns / 1'000'000'000), static_cast<long>(target_ns % 1'000'000'000)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        }
+    };
+}
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, StringlikeTypes::can_replayer::str);
+    StaticInitDeinit static_init_deinit;
+
+    CanReplayerNode can_replayer_node;
+
+    if(!can_replayer_node.is_open()) return 1;
+
+    ROS_INFO("%s node has started.", StringlikeTypes::can_replayer::str);
+
+    can_replayer_node.run();
+
+    ROS_INFO("%s node has terminated.", StringlikeTypes::can_replayer::str);
+}
@@ -0,0 +1,162 @@
+/*
+共有メモリのリング(Config::CanTx::shm_ring_name)を読んでcan_txに流すノード。
+slcan_bridgeがリングを直接読めるようになるまでの代役で、積まれてから取り出すまでの遅延も測る。
+バス側でリングを直接読むものはまだないので、今はこのノードがROSでcan_txに流しなおしている。
+つまりROSの一段は減っておらず、リングを挟むぶん一段増えている。Config::CanTx::use_shm_ringを既定でfalseにしているのはそのため。
+
+このノードがConfig::CanTx::shm_consumer_timeout以上止まると、書く側はcan_txに直接送るほうに切り替える。
+そのときリングに残っていたものを後から流すと、もう直接送られた新しいフレームより後にバスに出て順番が入れ替わる。
+なので前の生存確認から間が空きすぎたら(書く側が切り替えたかもしれない)、その時点より前に積まれたものは流さずに捨てる。
+書く側は新しい生存確認を見てから積むので、それより後の時刻がついている。捨てるのはこちら(読む側)だけで、書く側はリングに触らない。
+*/
+
+#include <cstdint>
+#include <limits>
+
+#include <time.h>
+
+#include <ros/ros.h>
+#include <can_plugins/Frame.h>
+
+#include "harurobo2022/config.hpp"
+#include "harurobo2022/topic.hpp"
+#include "harurobo2022/publisher.hpp"
+#include "harurobo2022/stringlike_types.hpp"
+#include "harurobo2022/can_shm_ring.hpp"
+#include "harurobo2022/static_init_deinit.hpp"
+
+using namespace Harurobo2022;
+
+namespace
+{
+    class CanShmBridgeNode final
+    {
+        using can_tx = Topic<StringlikeTypes::can_tx, can_plugins::Frame>;
+
+        Publisher<can_tx> can_tx_pub{1000};
+
+        CanShmRing shm_ring{CanShmRing::create(Config::CanTx::shm_ring_name)};
+
+        // 1秒ごとに出して捨てる。
+        struct LatencyStat final
+        {
+            std::uint64_t count{0};
+            std::uint64_t sum_ns{0};
+            std::uint64_t min_ns{std::numeric_limits<std::uint64_t>::max()};
+            std::uint64_t max_ns{0};
+
+            void add(const std::uint64_t latency_ns) noexcept
+            {
+                ++count;
+                sum_ns += latency_ns;
+                if(latency_ns < min_ns) min_ns = latency_ns;
+                if(latency_ns > max_ns) max_ns = latency_ns;
+            }
+        } latency_stat{};
+
+        std::uint64_t last_report_ns{StewLib::monotonic_ns()};
+
+        std::uint64_t last_beat_ns{StewLib::monotonic_ns()};
+        // これより前の時刻がついたものは、書く側が切り替えた後に残っていたものなので捨てる。
+        std::uint64_t stale_before_ns{0};
+        std::uint64_t stale_count{0};
+
+    public:
+        bool is_open() const noexcept
+        {
+            return shm_ring.is_open();
+        }
+
+        void run() noexcept
+        {
+            constexpr timespec idle_sleep{0, 20'000};
+            // 書く側が生存確認を読むのと、こちらが書くのとの前後の分だけ早めに見る。
+            constexpr std::uint64_t stall_ns = Config::CanTx::shm_consumer_timeout * 1'000'000'000 - 1'000'000;
+            static_assert(Config::CanTx::shm_consumer_timeout > 0.002, "shm_consumer_timeout is too short.");
+
+            while(ros::ok())
+            {
+                const std::uint64_t beat_ns = shm_ring.beat();
+                if(beat_ns - last_beat_ns >= stall_ns) stale_before_ns = beat_ns;
+                last_beat_ns = beat_ns;
+
+                bool is_empty = true;
+                CanShmRecord record;
+                while(shm_ring.try_pop(record))
+                {
+                    is_empty = false;
+
+                    if(record.stamp_ns < stale_before_ns)
+                    {
+                        ++stale_count;
+                        continue;
+                    }
+
+                    latency_stat.add(StewLib::monotonic_ns() - record.stamp_ns);
+                    can_tx_pub.publish(record.frame);
+                }
+
+                const std::uint64_t now_ns = StewLib::monotonic_ns();
+                if(now_ns - last_report_ns > 1'000'000'000)
+                {
+                    report();
+                    last_report_ns = now_ns;
+                }
+
+                if(is_empty)
+                {
+                    clock_nanosleep(CLOCK_MONOTONIC, 0, &idle_sleep, nullptr);
+                }
+            }
+        }
+
+    private:
+        void report() noexcept
+        {
+            if(latency_stat.count)
+            {
+                ROS_INFO
+                (
+                    "%s: %lu frames, latency min %.1lf us, mean %.1lf us, max %.1lf us",
+                    StringlikeTypes::can_shm_bridge::str,
+                    static_cast<unsigned long>(latency_stat.count),
+                    latency_stat.min_ns / 1e3,
+                    static_cast<double>(latency_stat.sum_ns) / latency_stat.count / 1e3,
+                    latency_stat.max_ns / 1e3
+                );
+            }
+
+            latency_stat = {};
+
+            if(stale_count)
+            {
+                ROS_WARN
+                (
+                    "%s: %lu frames left in the ring after a stall were dropped.",
+                    StringlikeTypes::can_shm_bridge::str, static_cast<unsigned long>(stale_count)
+                );
+                stale_count = 0;
+            }
+        }
+    };
+}
+
+int main(int argc, char ** argv)
+{
+    ros::init(argc, argv, StringlikeTypes::can_shm_bridge::str);
+    StaticInitDeinit static_init_deinit;
+
+    CanShmBridgeNode can_shm_bridge_node;
+
+    if(!can_shm_bridge_node.is_open())
+    {
+        ROS_ERROR("%s: failed to create %s.", StringlikeTypes::can_shm_bridge::str, Config::CanTx::shm_ring_name);
+        return 1;
+    }
+
+    ROS_INFO("%s node has started.", StringlikeTypes::can_shm_bridge::str);
+
+    can_shm_bridge_node.run();
+
+    ROS_INFO("%s node has terminated.", StringlikeTypes::can_shm_bridge::str);
+}
@@ -1,15 +1,30 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include <ros/ros.h>
 
+#include "harurobo2022/lib/can_codec.hpp"
+#include "harurobo2022/config.hpp"
+#include "harurobo2022/has_members.hpp"
 #include "harurobo2022/topic.hpp"
 #include "harurobo2022/topics/odometry.hpp"
 #include "harurobo2022/publisher.hpp"
 #include "harurobo2022/subscriber.hpp"
+#include "harurobo2022/timer.hpp"
 #include "harurobo2022/static_init_deinit.hpp"
 
+#ifdef HARUROBO2022_NODELET
+#include <pluginlib/class_list_macros.h>
+#include "harurobo2022/nodelet.hpp"
+#elif defined(HARUROBO2022_SIM)
+#include "harurobo2022/sim_node.hpp"
+#endif
+
 using namespace Harurobo2022;
 
 namespace
@@ -24,6 +39,11 @@ namespace
 
     using can_rx = Topic<CanSubscriberImplement::can_rx, can_plugins::Frame>;
 
+    /*
+    一つのIDについて、複数フレームに分けて送られてくるRawDataを組み立てなおす。
+    フレームに通し番号はないので、頭以外のフレームは8バイト、最後だけ余りの長さ、という長さの並びで位置を確かめる。
+    長さが合わないか、前のフレームから間が空きすぎたら途中までのものは捨てて頭から数えなおす。
+    */
     template<class CanRxTopic_>
     struct CanRxBuffer final
     {
@@ -32,9 +52,17 @@ namespace
 
         using MessageConvertor = CanRxTopic::MessageConvertor;
         using RawData = MessageConvertor::RawData;
+        static_assert(std::is_trivially_copyable_v<RawData>, "RawData must be trivially copyable.");
+
+        using Layout = StewLib::CanFrameLayout<sizeof(RawData)>;
+        constexpr static std::size_t frame_count = Layout::frame_count;
+
+        RawData raw_data{};
+        std::size_t next_index{0};
+        ros::Time last_stamp{};
 
-        std::uint8_t buffer[sizeof(RawData)]{};
-        std::uint8_t * p{buffer};
+        std::uint64_t completed_count{0};
+        std::uint64_t dropped_count{0};
 
         Publisher<CanRxTopic,PublisherOption{.disable_can_rx_topic_assert = true}> data_pub;
 
@@ -45,19 +73,175 @@ namespace
         inline void push(const typename can_rx::MessageConvertor::Message::ConstPtr& msg_p) noexcept
         {
             const std::uint8_t dlc = msg_p->dlc;
-            std::memcpy(p, msg_p->data.data(), dlc);
+            const ros::Time stamp = receive_stamp(*msg_p);
 
-            p += dlc;
+            // コールバックが呼ばれた時刻ではなくフレームを受け取った時刻で比べる。can_rxのキューに溜まっていても間違えて捨てない。
+            if(next_index && (stamp - last_stamp).toSec() > Config::CanRx::reassembly_timeout)
+            {
+                resync();
+            }
+            last_stamp = stamp;
 
-            if(p - buffer > (std::ptrdiff_t)sizeof(RawData))
+            if(dlc != expected_dlc(next_index))
             {
-                p = buffer;
-                RawData raw_data;
-                std::memcpy(&raw_data, buffer, sizeof(RawData));
-                typename CanRxTopic::Message msg = MessageConvertor(raw_data);
-                data_pub.publish(msg);
+                resync();
+
+                // 頭のフレームだった可能性があればそこから数えなおす。
+                if(dlc != expected_dlc(0)) return;
+            }
+
+            std::memcpy(reinterpret_cast<std::uint8_t *>(&raw_data) + 8 * next_index, msg_p->data.data(), dlc);
+
+            if(++next_index == frame_count)
+            {
+                next_index = 0;
+                ++completed_count;
+
+                MessageConvertor conv(raw_data);
+                if constexpr(StewLib::has_stamp_v<MessageConvertor>)
+                {
+                    // 組み上がった最後のフレームを受け取った時刻。キューで待った時間は含めない。
+                    conv.stamp = stamp;
+                }
+                data_pub.publish(conv);
             }
         }
+
+    private:
+        // slcan_bridgeが受け取ったときの時刻。入っていなければここで受け取った時刻で代える。
+        static ros::Time receive_stamp(const typename can_rx::MessageConvertor::Message& msg) noexcept
+        {
+            return msg.header.stamp.isZero() ? ros::Time::now() : msg.header.stamp;
+        }
+
+        constexpr static std::uint8_t expected_dlc(const std::size_t index) noexcept
+        {
+            return Layout::dlc(index);
+        }
+
+        void resync() noexcept
+        {
+            if(next_index) ++dropped_count;
+            next_index = 0;
+        }
+    };
+
+    namespace CanRxRouterImplement
+    {
+        // 標準IDは11bitしかないので、IDをそのまま添え字にする。
+        inline constexpr std::size_t standard_id_size = 0x800;
+        inline constexpr std::uint8_t unknown_index = 0xFF;
+        inline constexpr std::uint8_t ignored_index = 0xFE;
+
+        template<class ... CanRxTopics>
+        constexpr std::array<std::uint8_t, standard_id_size> make_id_table() noexcept
+        {
+            std::array<std::uint8_t, standard_id_size> table{};
+            for(auto& index : table) index = unknown_index;
+            for(const auto id : Config::CanId::Rx::ignored) table[id] = ignored_index;
+
+            std::uint8_t index = 0;
+            ((table[CanRxTopics::id] = index++), ...);
+
+            return table;
+        }
+
+        template<class ... CanRxTopics>
+        constexpr bool is_ids_unique() noexcept
+        {
+            constexpr std::uint16_t ids[] = {CanRxTopics::id ...};
+            for(std::size_t i = 0; i < sizeof...(CanRxTopics); ++i)
+            {
+                for(std::size_t j = i + 1; j < sizeof...(CanRxTopics); ++j)
+                {
+                    if(ids[i] == ids[j]) return false;
+                }
+            }
+            return true;
+        }
+
+        template<class ... CanRxTopics>
+        constexpr bool is_ignored_ids_valid() noexcept
+        {
+            for(const auto id : Config::CanId::Rx::ignored)
+            {
+                if(id >= standard_id_size || ((id == CanRxTopics::id) || ...)) return false;
+            }
+            return true;
+        }
+    }
+
+    // 受け取ったフレームをIDで引いた表から該当するCanRxBufferへ流す。分岐の連鎖は作らない。
+    template<class ... CanRxTopics>
+    class CanRxRouter final
+    {
+        static_assert((is_can_rx_topic_v<CanRxTopics> && ...), "arguments must be can_rx topics.");
+        static_assert(sizeof...(CanRxTopics) < CanRxRouterImplement::ignored_index, "too many can_rx topics.");
+        static_assert(((CanRxTopics::id < CanRxRouterImplement::standard_id_size) && ...), "can_rx topic id must be standard id.");
+        static_assert(CanRxRouterImplement::is_ids_unique<CanRxTopics ...>(), "can_rx topic ids must be unique.");
+        static_assert(CanRxRouterImplement::is_ignored_ids_valid<CanRxTopics ...>(), "Config::CanId::Rx::ignored must be standard ids and must not overlap can_rx topic ids.");
+
+        using Handler = void (*)(CanRxRouter&, const typename can_rx::Message::ConstPtr&) noexcept;
+
+        constexpr static auto id_table = CanRxRouterImplement::make_id_table<CanRxTopics ...>();
+
+        std::tuple<CanRxBuffer<CanRxTopics> ...> buffers;
+
+    public:
+        // 知らないIDはROS_ERRORせずに数えるだけ。Config::CanId::Rx::ignoredのものはこちらにも数えない。
+        std::uint64_t unknown_count{0};
+        std::uint32_t last_unknown_id{0};
+        std::uint64_t ignored_count{0};
+
+        // 組み立て途中で捨てたサンプルの総数
+        std::uint64_t dropped_count() const noexcept
+        {
+            return std::apply([](const auto& ... each) noexcept { return (std::uint64_t{0} + ... + each.dropped_count); }, buffers);
+        }
+
+        CanRxRouter(const std::uint32_t pub_queue_size) noexcept:
+            buffers{((void)CanRxTopics::id, pub_queue_size) ...}
+        {}
+
+        void route(const typename can_rx::Message::ConstPtr& msg_p) noexcept
+        {
+            constexpr auto handlers = make_handlers(std::index_sequence_for<CanRxTopics ...>());
+
+            const std::uint32_t id = msg_p->id;
+
+            if(!msg_p->is_extended && id < CanRxRouterImplement::standard_id_size)
+            {
+                const std::uint8_t index = id_table[id];
+
+                if(index == CanRxRouterImplement::ignored_index)
+                {
+                    ++ignored_count;
+                    return;
+                }
+
+                if(index != CanRxRouterImplement::unknown_index)
+                {
+                    handlers[index](*this, msg_p);
+                    return;
+                }
+            }
+
+            ++unknown_count;
+            last_unknown_id = id;
+        }
+
+    private:
+        template<std::size_t index>
+        static void push(CanRxRouter& router, const typename can_rx::Message::ConstPtr& msg_p) noexcept
+        {
+            std::get<index>(router.buffers).push(msg_p);
+        }
+
+        template<std::size_t ... indices>
+        constexpr static std::array<Handler, sizeof...(CanRxTopics)> make_handlers(std::index_sequence<indices ...>) noexcept
+        {
+            return {&push<indices> ...};
+        }
     };
 
     class CanSubscriberNode final
@@ -71,34 +255,42 @@ namespace
             }
         };
 
-        CanRxBuffer<Topics::odometry_x> odometry_x_unpacker{1};
-        CanRxBuffer<Topics::odometry_y> odometry_y_unpacker{1};
-        CanRxBuffer<Topics::odometry_yaw> odometry_yaw_unpacker{1};
+        // 受信するトピックはここに足すだけでよい。
+        CanRxRouter
+        <
+            Topics::odometry
+        > router{1};
+
+        std::uint64_t reported_unknown_count{0};
+        std::uint64_t reported_dropped_count{0};
+        Timer report_timer{1.0, [this](const ros::TimerEvent&) noexcept { report(); }, "can_subscriber/report_timer"};
 
         void can_rx_callback(const can_rx::Message::ConstPtr& msg_p) noexcept
         {
-            const auto id = msg_p->id;
+            router.route(msg_p);
+        }
+
+        void report() noexcept
+        {
+            const std::uint64_t dropped_count = router.dropped_count();
+            if(dropped_count != reported_dropped_count)
+            {
+                ROS_WARN
+                (
+                    "%s: %lu partially received samples were dropped in total.",
+                    CanSubscriberImplement::can_subscriber::str, static_cast<unsigned long>(dropped_count)
+                );
+                reported_dropped_count = dropped_count;
+            }
 
-            switch(id)
+            if(router.unknown_count != reported_unknown_count)
             {
-            case Topics::odometry_x::id:
-                odometry_x_unpacker.push(msg_p);
-                break;
-            
-            case Topics::odometry_y::id:
-                odometry_y_unpacker.push(msg_p);
-                break;
-            
-            case Topics::odometry_yaw::id:
-                odometry_yaw_unpacker.push(msg_p);
-                break;
-
-            // debug
-            case 1058:
-                break;
-
-            default:
-                ROS_ERROR("Unknown message arrived from usb_can_node. id: %d", id);
+                ROS_WARN
+                (
+                    "%s: %lu unknown frames arrived from usb_can_node in total. last id: %u",
+                    CanSubscriberImplement::can_subscriber::str, static_cast<unsigned long>(router.unknown_count), router.last_unknown_id
+                );
+                reported_unknown_count = router.unknown_count;
             }
         }
     };
@@ -107,6 +299,22 @@ namespace
 using namespace Harurobo2022;
 using namespace CanSubscriberImplement;
 
+#ifdef HARUROBO2022_NODELET
+
+namespace Harurobo2022Nodelets
+{
+    class CanSubscriber final : public NodeletBase<CanSubscriberNode, CanSubscriberImplement::can_subscriber>
+    {};
+}
+
+PLUGINLIB_EXPORT_CLASS(Harurobo2022Nodelets::CanSubscriber, nodelet::Nodelet)
+
+#elif defined(HARUROBO2022_SIM)
+
+HARUROBO2022_SIM_EXPORT_NODE(CanSubscriberNode, CanSubscriberImplement::can_subscriber)
+
+#else
+
 int main(int argc, char ** argv)
 {
     ros::init(argc, argv, can_subscriber::str);
@@ -121,3 +329,5 @@ int main(int argc, char ** argv)
     ROS_INFO("%s node has terminated.", can_subscriber::str);
 
 }
+
+#endif
@@ -40,6 +40,12 @@
 #include "harurobo2022/state.hpp"
 #include "harurobo2022/timer.hpp"
 #include "harurobo2022/motors.hpp"
+#include "harurobo2022/trace.hpp"
+
+#ifdef HARUROBO2022_NODELET
+#include <pluginlib/class_list_macros.h>
+#include "harurobo2022/nodelet.hpp"
+#endif
 
 using namespace StewLib;
 using namespace Harurobo2022;
@@ -170,10 +176,15 @@ namespace
         StateManager state_manager
         {};
 
-        Timer timer{1.0 / Config::ExecutionInterval::manual_commander_freq, [this](const ros::TimerEvent& event) noexcept { timerCallback(event); }};
+        Timer timer{1.0 / Config::ExecutionInterval::manual_commander_freq, [this](const ros::TimerEvent& event) noexcept { timerCallback(event); }, "manual_commander/timer"};
 
         JoyInput joy_input{};
 
+        // Joyを受け取るたびに振る番号。0は追いかけない印なので1から。
+        std::uint32_t trace_id{0};
+        ros::Time joy_stamp{};
+        std::uint32_t last_commanded_trace_id{0};
+
 
     public:
         ManualCommanderNode() = default;
@@ -182,10 +193,16 @@ namespace
         void joyCallback(const sensor_msgs::Joy& joy_msg)
         {
             joy_input.update(joy_msg);
+
+            if(!++trace_id) ++trace_id;
+            joy_stamp = joy_msg.header.stamp.isZero() ? ros::Time::now() : joy_msg.header.stamp;
+            Trace::record(trace_id, Trace::Stage::input, joy_stamp);
         }
 
         void timerCallback(const ros::TimerEvent&)
         {
+            CanTxBatch can_tx_batch{};
+
             switch(state_manager.get_state())
             {
             case State::disable:
@@ -234,8 +251,17 @@ namespace
 
             // ROS_INFO("cmd_vel %lf, %lf", cmd_vel.linear_x, cmd_vel.linear_y);
 
+            cmd_vel.header.seq = trace_id;
+            cmd_vel.header.stamp = joy_stamp;
+
             body_twist_pub.publish(cmd_vel);
 
+            if(trace_id != last_commanded_trace_id)
+            {
+                Trace::record(trace_id, Trace::Stage::command);
+                last_commanded_trace_id = trace_id;
+            }
+
             if(joy_input.is_being_pushed(Buttons::x) && joy_input.is_pushed_once(CrossKey::U))
             {
                 lift_motors.collector_pub.send_target(Config::collector_step3_position);
@@ -327,18 +353,33 @@ namespace
     };
 }
 
+#ifdef HARUROBO2022_NODELET
+
+namespace Harurobo2022Nodelets
+{
+    class ManualCommander final : public NodeletBase<ManualCommanderNode, StringlikeTypes::manual_commander>
+    {};
+}
+
+PLUGINLIB_EXPORT_CLASS(Harurobo2022Nodelets::ManualCommander, nodelet::Nodelet)
+
+#else
+
 int main(int argc, char** argv)
 {
     ros::init(argc, argv, StringlikeTypes::manual_commander::str);
     StaticInitDeinit static_init_deinit;
 
+    RtExecutor rt_executor{Config::RtExecutor::Cpu::manual_commander};
     ManualCommanderNode manual_commander_node;
     
     ROS_INFO("%s node has started.", StringlikeTypes::manual_commander::str);
     
-    ros::spin();
+    rt_executor.spin();
     
     ROS_INFO("%s node has terminated.", StringlikeTypes::manual_commander::str);
     
     return 0;
-}
\ No newline at end of file
+}
+
+#endif
@@ -9,6 +9,13 @@
 #include "harurobo2022/topics/table_cloth.hpp"
 #include "harurobo2022/topics/stepping_motor.hpp"
 
+#ifdef HARUROBO2022_NODELET
+#include <pluginlib/class_list_macros.h>
+#include "harurobo2022/nodelet.hpp"
+#elif defined(HARUROBO2022_SIM)
+#include "harurobo2022/sim_node.hpp"
+#endif
+
 using namespace Harurobo2022;
 
 namespace
@@ -35,6 +42,8 @@ namespace
 
         void state_callback(const State& state) noexcept
         {
+            CanTxBatch can_tx_batch{};
+
             switch(state)
             {
             case State::disable:
@@ -144,6 +153,22 @@ namespace
     };
 }
 
+#ifdef HARUROBO2022_NODELET
+
+namespace Harurobo2022Nodelets
+{
+    class StateManager final : public NodeletBase<StateManagerNode, StringlikeTypes::state_manager>
+    {};
+}
+
+PLUGINLIB_EXPORT_CLASS(Harurobo2022Nodelets::StateManager, nodelet::Nodelet)
+
+#elif defined(HARUROBO2022_SIM)
+
+HARUROBO2022_SIM_EXPORT_NODE(StateManagerNode, StringlikeTypes::state_manager)
+
+#else
+
 int main(int argc, char ** argv)
 {
     ros::init(argc, argv, StringlikeTypes::state_manager::str);
@@ -156,4 +181,6 @@ int main(int argc, char ** argv)
     ros::spin();
 
     ROS_INFO("%s node has terminated.", StringlikeTypes::state_manager::str);
-}
\ No newline at end of file
+}
+
+#endif
@@ -8,6 +8,8 @@ base_controllerを参考にした。
 #include <geometry_msgs/Twist.h>
 
 #include "harurobo2022/lib/vec2d.hpp"
+#include "harurobo2022/lib/omni_kinematics.hpp"
+#include "harurobo2022/lib/rate_limiter.hpp"
 #include "harurobo2022/config.hpp"
 #include "harurobo2022/topics/body_twist.hpp"
 #include "harurobo2022/topics/under_carriage_4wheel_active.hpp"
@@ -15,6 +17,14 @@ base_controllerを参考にした。
 #include "harurobo2022/static_init_deinit.hpp"
 #include "harurobo2022/motors.hpp"
 #include "harurobo2022/timer.hpp"
+#include "harurobo2022/trace.hpp"
+
+#ifdef HARUROBO2022_NODELET
+#include <pluginlib/class_list_macros.h>
+#include "harurobo2022/nodelet.hpp"
+#elif defined(HARUROBO2022_SIM)
+#include "harurobo2022/sim_node.hpp"
+#endif
 
 using namespace StewLib;
 using namespace Harurobo2022;
@@ -26,12 +36,18 @@ namespace
     {
 
 
-        Timer publish_timer{1.0 / Config::ExecutionInterval::under_carriage_freq, [this](const ros::TimerEvent& event) noexcept { publish_timer_callback(event); }};
+        Timer publish_timer{1.0 / Config::ExecutionInterval::under_carriage_freq, [this](const ros::TimerEvent& event) noexcept { publish_timer_callback(event); }, "under_carriage_4wheel/publish_timer"};
 
         DriveMotors drive_motors{};
 
+        RateLimiter<4> rate_limiter
+        {
+            {Config::Limitation::wheel_vela, Config::Limitation::wheel_acca, Config::Limitation::wheel_jerk},
+            1.0 / Config::ExecutionInterval::under_carriage_freq
+        };
+
         bool is_active{false};
-        Subscriber<Topics::under_carriage_4wheel_active> active_sub{1, [this](const typename std_msgs::Bool::ConstPtr& msg_p){ is_active = msg_p->data; }};
+        Subscriber<Topics::under_carriage_4wheel_active> active_sub{1, [this](const typename std_msgs::Bool::ConstPtr& msg_p){ is_active = msg_p->data; if(!is_active) rate_limiter.reset(); }};
 
         Subscriber<Topics::body_twist> body_twist_sub
         {
@@ -40,14 +56,23 @@ namespace
             {
                 body_vell = {msg_p->linear_x, msg_p->linear_y};
                 body_vela = msg_p->angular_z;
+                body_twist_trace_id = msg_p->header.seq;
             }
         };
 
         Vec2D<double> body_vell{};
         double body_vela{};
 
+        std::uint32_t body_twist_trace_id{0};
+        std::uint32_t last_traced_id{0};
+
         double wheels_vela[4]{};
-        double pre_wheels_vela[4]{};
+
+        RateLimiter<4>::SaturationCount reported_count{};
+        Timer report_timer{1.0, [this](const ros::TimerEvent&) noexcept { report(); }, "under_carriage_4wheel/report_timer"};
+
+        CanTxStats reported_stats{};
+        Timer load_report_timer{Config::CanTx::load_report_interval, [this](const ros::TimerEvent&) noexcept { report_load(); }, "under_carriage_4wheel/load_report_timer"};
 
     public:
         UnderCarriage4WheelNode() noexcept
@@ -60,106 +85,99 @@ namespace
             
             calc_wheels_vela();
 
-            drive_motors.FR_pub.send_target(wheels_vela[0]);
-            drive_motors.FL_pub.send_target(wheels_vela[1]);
-            drive_motors.BL_pub.send_target(wheels_vela[2]);
-            drive_motors.BR_pub.send_target(wheels_vela[3]);
+            // 新しい指令を初めて反映した周期だけ記録する。
+            const std::uint32_t trace_id = (body_twist_trace_id != last_traced_id) ? body_twist_trace_id : 0;
+            last_traced_id = body_twist_trace_id;
+            Trace::record(trace_id, Trace::Stage::kinematics);
+            Trace::Scope trace_scope{trace_id};
+
+            CanTxBatch can_tx_batch{};
+
+            drive_motors.send_targets(wheels_vela);
         }
         
         inline void calc_wheels_vela() noexcept
         {
             using namespace Config::Wheel;
 
-            constexpr double rot_factors[4] =
-            {
-                Config::body_radius * rot(~Pos::FR,Constant::PI_2) * ~Direction::FR,
-                Config::body_radius * rot(~Pos::FL,Constant::PI_2) * ~Direction::FL,
-                Config::body_radius * rot(~Pos::BL,Constant::PI_2) * ~Direction::BL,
-                Config::body_radius * rot(~Pos::BR,Constant::PI_2) * ~Direction::BR
-            };
-
-            const auto body_vell = this->body_vell;
-            const auto body_vela = this->body_vela;
-            double wheels_vela[4];
+            static constexpr OmniKinematics<4> kinematics{Pos::all, Direction::all, Config::wheel_radius};
 
-            for(int i = 0; i < 4; ++i)
-            {
-                wheels_vela[i] = (~Direction::all[i] * body_vell + rot_factors[i] * body_vela) / Config::wheel_radius;
-            }
+            const double max_abs_vela = kinematics.inverse(body_vell, body_vela, wheels_vela);
+            rate_limiter(wheels_vela, max_abs_vela);
+        }
 
-            if constexpr (Config::Limitation::wheel_acca)
-            {
-                double diffs_vela[4];
-                for(int i = 0; i < 4; ++i)
-                {
-                    diffs_vela[i] = pre_wheels_vela[i] - wheels_vela[i];
-                }
-
-                auto max = diffs_vela[0];
-                for(int i = 1; i < 4; ++i)
-                {
-                    if(max < diffs_vela[i]) max = diffs_vela[i];
-                }
-                
-                if(max > Config::Limitation::wheel_acca)
-                {
-                    ROS_WARN("%s: warning: The accelaretion of the wheels is too high. Speed is limited.", StringlikeTypes::under_carriage_4wheel::str);
-                    auto limit_factor = Config::Limitation::wheel_acca / max;
-                    for(int i = 0; i < 4; ++i)
-                    {
-                        wheels_vela[i] += pre_wheels_vela[i] + (limit_factor * diffs_vela[i]);
-                    }
-                }
-
-                for(int i = 0; i < 4; ++i)
-                {
-                    this->wheels_vela[i] = wheels_vela[i];
-                }
-            }
+        // 1kHzの周期の中では警告を出さず、数だけ数えてここでまとめて出す。
+        void report() noexcept
+        {
+            const auto& count = rate_limiter.get_saturation_count();
 
-            if constexpr (Config::Limitation::wheel_vela)
+            if(count.vel != reported_count.vel || count.acc != reported_count.acc || count.jerk != reported_count.jerk)
             {
-                auto max = wheels_vela[0];
-                for(int i = 1; i < 4; ++i)
-                {
-                    if(max < wheels_vela[i]) max = wheels_vela[i];
-                }
-                
-                if(max > Config::Limitation::wheel_vela)
-                {
-                    ROS_WARN("%s: warning: The speed of the wheels is too high. Speed is limited.", StringlikeTypes::under_carriage_4wheel::str);
-                    auto limit_factor = Config::Limitation::wheel_vela / max;
-                    for(int i = 0; i < 4; ++i)
-                    {
-                        wheels_vela[i] *= limit_factor;
-                    }
-                }
+                ROS_WARN
+                (
+                    "%s: wheels are limited. velocity: %lu, acceleration: %lu, jerk: %lu times in total.",
+                    StringlikeTypes::under_carriage_4wheel::str, count.vel, count.acc, count.jerk
+                );
+                reported_count = count;
             }
+        }
 
-            if constexpr(Config::Limitation::wheel_acca)
-            {
-                for(int i = 0; i < 4; ++i)
-                {
-                    pre_wheels_vela[i] = wheels_vela[i];
-                }
-            }
+        // このノードが送ったぶんだけのバス使用率と、このノードが送ったIDの予算から見た使用率(can_tx_scheduler.hpp)。
+        void report_load() noexcept
+        {
+            const CanTxStats& stats = get_can_tx_stats();
+            const double frames = stats.frames - reported_stats.frames;
+            const double bits = stats.bits - reported_stats.bits;
+            const auto suppressed = stats.suppressed_frames - reported_stats.suppressed_frames;
+            const auto throttled = stats.throttled_frames - reported_stats.throttled_frames;
+            reported_stats = stats;
+
+            ROS_INFO
+            (
+                "%s: can tx %.0f frames/s, bus load %.1f %% (projected %.1f %%, %.1f %% for the whole bus), %lu frames suppressed, %lu throttled.",
+                StringlikeTypes::under_carriage_4wheel::str,
+                frames / Config::CanTx::load_report_interval,
+                bits / Config::CanTx::load_report_interval / Config::CanTx::bitrate * 100,
+                CanTxScheduler::active_projected_load() * 100,
+                can_tx_projected_load * 100,
+                static_cast<unsigned long>(suppressed),
+                static_cast<unsigned long>(throttled)
+            );
         }
     };
 }
 
+#ifdef HARUROBO2022_NODELET
+
+namespace Harurobo2022Nodelets
+{
+    class UnderCarriage4Wheel final : public NodeletBase<UnderCarriage4WheelNode, StringlikeTypes::under_carriage_4wheel>
+    {};
+}
+
+PLUGINLIB_EXPORT_CLASS(Harurobo2022Nodelets::UnderCarriage4Wheel, nodelet::Nodelet)
+
+#elif defined(HARUROBO2022_SIM)
+
+HARUROBO2022_SIM_EXPORT_NODE(UnderCarriage4WheelNode, StringlikeTypes::under_carriage_4wheel)
+
+#else
+
 int main(int argc, char ** argv)
 {
     ros::init(argc, argv, StringlikeTypes::under_carriage_4wheel::str);
     StaticInitDeinit static_init_deinit;
 
+    RtExecutor rt_executor{Config::RtExecutor::Cpu::under_carriage};
     UnderCarriage4WheelNode under_carriage_4wheel_node;
 
     ROS_INFO("%s node has started.", StringlikeTypes::under_carriage_4wheel::str);
     ROS_INFO("sizeof(MessageConvertor<std_msgs::Float32>::CanData) %ld", sizeof(MessageConvertor<std_msgs::Float32>::CanData));
 
-    ros::spin();
+    rt_executor.spin();
 
     ROS_INFO("%s node has terminated.", StringlikeTypes::under_carriage_4wheel::str);
 
 }
 
+#endif
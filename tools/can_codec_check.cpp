@@ -0,0 +1,60 @@
+/*
+
+can_codec.hppの確かめを実行時にやる。ROSには依存しない。
+
+std::bit_castがない環境(NUCのg++-9)ではcan_codec.hppのstatic_assertが効かないので、
+HARUROBO2022_CAN_CODEC_NO_BIT_CASTでmemcpyの方を使うようにビルドして、同じ1~64バイトの全部を確かめる。
+全部通れば0、どれかが違えば1を返す。
+
+使い方:
+    can_codec_check
+
+*/
+
+#include <cstddef>
+#include <cstdio>
+#include <utility>
+
+#include "harurobo2022/lib/can_codec.hpp"
+
+using namespace StewLib;
+
+namespace
+{
+    template<std::size_t ... sizes>
+    std::size_t count_broken_frames(std::index_sequence<sizes ...>) noexcept
+    {
+        std::size_t broken = 0;
+
+        ([&broken]() noexcept
+        {
+            if(!CanCodecImplement::check_frames<sizes + 1>())
+            {
+                std::printf("CanFrames<%zu bytes>: broken\n", sizes + 1);
+                ++broken;
+            }
+        }(), ...);
+
+        return broken;
+    }
+}
+
+int main()
+{
+#if defined(__cpp_lib_bit_cast) && !defined(HARUROBO2022_CAN_CODEC_NO_BIT_CAST)
+    std::printf("bit_cast: std::bit_cast\n");
+#else
+    std::printf("bit_cast: memcpy\n");
+#endif
+
+    std::size_t broken = count_broken_frames(std::make_index_sequence<64>());
+
+    if(!CanCodecImplement::check_values())
+    {
+        std::printf("byteswap / EndianBuffer: broken\n");
+        ++broken;
+    }
+
+    std::printf("%zu broken.\n", broken);
+    return broken ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+/*
+
+チャートのcsvを確かめて、バイナリに書き出す。ROSには依存しない。
+
+使い方:
+    chart_convert chart.csv chart.bin   csvを読んでバイナリに
+    chart_convert chart.csv             読めるか確かめて中身を表示するだけ(バイナリも読める)
+    chart_convert --builtin chart.bin   ビルド時に埋め込んだチャートをバイナリに
+
+*/
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "harurobo2022/csv_parser.hpp"
+
+using namespace Harurobo2022;
+
+namespace
+{
+    void print(const ChartView& chart) noexcept
+    {
+        std::printf("%zu commands\n", chart.size());
+        for(std::size_t i = 0; i < chart.size(); ++i)
+        {
+            const auto& command = chart[i];
+            const auto& circle = command.pass_near_circle;
+            std::printf("%4zu: %10.3f, %10.3f, %8.3f, %8.4f, %u\n", i + 1, circle.center.x, circle.center.y, circle.range, command.target_rot_z, static_cast<unsigned int>(command.work));
+        }
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    if(argc < 2 || argc > 3)
+    {
+        std::fprintf(stderr, "usage: %s chart.csv [chart.bin]\n       %s --builtin chart.bin\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    if(std::strcmp(argv[1], "--builtin") == 0)
+    {
+        if(argc != 3 || !ChartFile::write_binary(argv[2], StaticChart::chart1))
+        {
+            std::fprintf(stderr, "failed to write builtin chart.\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    ChartError error{};
+    const auto chart_file = ChartFile::load(argv[1], error);
+    if(!chart_file)
+    {
+        std::fprintf(stderr, "%s:%zu:%zu: %s\n", argv[1], error.line, error.column, error.what);
+        return 1;
+    }
+
+    if(argc == 2)
+    {
+        print(chart_file->view());
+        return 0;
+    }
+
+    if(!ChartFile::write_binary(argv[2], chart_file->view()))
+    {
+        std::fprintf(stderr, "failed to write %s.\n", argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+
+RateLimiter(lib/rate_limiter.hpp)が上限を守るかを確かめる。ROSには依存しない。
+
+ステップとランプの入力を何通りか流し、周期ごとの出力から
+    速度 |v| <= vel
+    加速度 |Δv| / dt <= acc
+    加加速度 |Δa| / dt <= jerk
+を見る。目標が変わらない区間では、目標を越えず、最後は目標に加速度0で着くことも見る。
+全部通れば0、どれかが違えば1を返す。
+
+使い方:
+    rate_limiter_check
+
+*/
+
+#include <cstddef>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include "harurobo2022/lib/rate_limiter.hpp"
+
+namespace
+{
+    constexpr std::size_t N = 4;
+    using Limiter = StewLib::RateLimiter<N>;
+
+    // 浮動小数点の誤差の分だけ緩める。
+    constexpr double tolerance = 1e-6;
+
+    struct Checker final
+    {
+        const char * name;
+        Limiter::Limit limit;
+        double dt;
+
+        Limiter limiter{limit, dt};
+        double pre_vel[N]{};
+        double pre_acc[N]{};
+
+        double max_vel{0};
+        double max_acc{0};
+        double max_jerk{0};
+        double max_overshoot{0};
+        std::size_t broken{0};
+
+        // commandを入れてstepsだけ回す。is_holdなら目標は変わらないものとして、越えたかと着いたかも見る。
+        void run(const double (&command)[N], const std::size_t steps, const bool is_hold) noexcept
+        {
+            double target[N];
+            double max_abs_command = 0;
+            for(std::size_t i = 0; i < N; ++i) max_abs_command = std::max(max_abs_command, std::abs(command[i]));
+            const double factor = (limit.vel && max_abs_command > limit.vel) ? limit.vel / max_abs_command : 1;
+            for(std::size_t i = 0; i < N; ++i) target[i] = command[i] * factor;
+
+            // 目標がどちら側にあるか(回し始めた時点で)。
+            double side[N];
+            for(std::size_t i = 0; i < N; ++i) side[i] = target[i] - pre_vel[i];
+
+            for(std::size_t k = 0; k < steps; ++k)
+            {
+                double vel[N];
+                for(std::size_t i = 0; i < N; ++i) vel[i] = command[i];
+                limiter(vel);
+                step(vel);
+
+                if(is_hold)
+                {
+                    for(std::size_t i = 0; i < N; ++i)
+                    {
+                        const double overshoot = (side[i] >= 0) ? vel[i] - target[i] : target[i] - vel[i];
+                        max_overshoot = std::max(max_overshoot, overshoot);
+                    }
+                }
+            }
+
+            if(is_hold)
+            {
+                for(std::size_t i = 0; i < N; ++i)
+                {
+                    if(std::abs(pre_vel[i] - target[i]) > tolerance || std::abs(pre_acc[i]) > tolerance)
+                    {
+                        std::printf("%s: did not settle. wheel %zu vel %f target %f acc %f\n", name, i, pre_vel[i], target[i], pre_acc[i]);
+                        ++broken;
+                    }
+                }
+            }
+        }
+
+        // fromからtoまでstepsかけて目標を直線で動かす。
+        void ramp(const double (&from)[N], const double (&to)[N], const std::size_t steps) noexcept
+        {
+            for(std::size_t k = 1; k <= steps; ++k)
+            {
+                double vel[N];
+                for(std::size_t i = 0; i < N; ++i) vel[i] = from[i] + (to[i] - from[i]) * k / steps;
+                limiter(vel);
+                step(vel);
+            }
+        }
+
+        void step(const double (&vel)[N]) noexcept
+        {
+            for(std::size_t i = 0; i < N; ++i)
+            {
+                const double acc = (vel[i] - pre_vel[i]) / dt;
+                const double jerk = (acc - pre_acc[i]) / dt;
+
+                max_vel = std::max(max_vel, std::abs(vel[i]));
+                max_acc = std::max(max_acc, std::abs(acc));
+                max_jerk = std::max(max_jerk, std::abs(jerk));
+
+                pre_vel[i] = vel[i];
+                pre_acc[i] = acc;
+            }
+        }
+
+        bool report() noexcept
+        {
+            const auto over = [](const double value, const double bound) noexcept { return bound && value > bound * (1 + tolerance) + tolerance; };
+
+            if(over(max_vel, limit.vel)) ++broken;
+            if(over(max_acc, limit.acc)) ++broken;
+            if(over(max_jerk, limit.jerk)) ++broken;
+            if(max_overshoot > tolerance) ++broken;
+
+            std::printf
+            (
+                "%s: max vel %.3f / %.3f, acc %.3f / %.3f, jerk %.3f / %.3f, overshoot %.6f. %s\n",
+                name, max_vel, limit.vel, max_acc, limit.acc, max_jerk, limit.jerk, max_overshoot, broken ? "broken" : "ok"
+            );
+
+            return !broken;
+        }
+    };
+
+    bool check(const char *const name, const Limiter::Limit& limit, const double dt) noexcept
+    {
+        Checker checker{name, limit, dt};
+
+        // 止まっているところからのステップ、向きの逆転、上限を越える指令、0に戻す、小さいステップ。
+        checker.run({50, 20, -50, 10}, 2000, true);
+        checker.run({-80, 10, 80, -40}, 2000, true);
+        checker.run({200, -100, 50, 0}, 2000, true);
+        checker.run({0, 0, 0, 0}, 2000, true);
+        checker.run({1e-3, -1e-3, 0, 2e-3}, 2000, true);
+        checker.run({90, -90, 90, -90}, 2000, true);
+
+        // 目標が途中で手前に変わる(越えるのはよいが、上限は守る)。
+        checker.run({-90, 90, -90, 90}, 30, false);
+        checker.run({0, 0, 0, 0}, 2000, true);
+
+        // ランプ。速いものは加速度の上限を越える傾き。
+        checker.ramp({0, 0, 0, 0}, {60, -30, 20, 0}, 200);
+        checker.ramp({60, -30, 20, 0}, {-60, 30, -20, 0}, 20);
+        checker.ramp({-60, 30, -20, 0}, {0, 0, 0, 0}, 1000);
+        checker.run({0, 0, 0, 0}, 2000, true);
+
+        return checker.report();
+    }
+}
+
+int main()
+{
+    bool is_ok = true;
+
+    is_ok &= check("vel 90, acc 900, jerk 20000", {90, 900, 20000}, 0.001);
+    is_ok &= check("vel 90, acc 900, jerk 9000", {90, 900, 9000}, 0.001);
+    is_ok &= check("vel 90, acc 900, jerk 2000", {90, 900, 2000}, 0.001);
+    is_ok &= check("vel 30, acc 300, jerk 50000, dt 0.005", {30, 300, 50000}, 0.005);
+
+    return is_ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/*
+
+trace.hppが書き出したcsvを読んで、段階ごとの遅れを集計する。ROSには依存しない。
+
+使い方:
+    trace_report /tmp/harurobo2022_trace_*.csv
+
+同じtrace idの記録をノードを跨いで集め、各段階で一番早い時刻を取る。
+全部の段階が揃わなかった番号(手動以外で流れたものや、途中で捨てられたもの)は数えるだけにする。
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t stage_size = 4;
+    constexpr const char * stage_names[stage_size] = {"input", "command", "kinematics", "can_enqueue"};
+    constexpr std::uint64_t none = std::numeric_limits<std::uint64_t>::max();
+
+    using Stamps = std::array<std::uint64_t, stage_size>;
+
+    bool load(const char *const path, std::map<std::uint32_t, Stamps>& traces) noexcept
+    {
+        std::FILE *const fp = std::fopen(path, "r");
+        if(!fp)
+        {
+            std::fprintf(stderr, "failed to open %s.\n", path);
+            return false;
+        }
+
+        // 1行目は見出し。
+        int c;
+        while((c = std::fgetc(fp)) != EOF && c != '\n');
+
+        std::uint32_t trace_id;
+        unsigned stage;
+        std::uint64_t stamp_ns;
+        std::size_t line = 1;
+        while(std::fscanf(fp, "%u,%u,%lu\n", &trace_id, &stage, &stamp_ns) == 3)
+        {
+            ++line;
+            if(stage >= stage_size)
+            {
+                std::fprintf(stderr, "%s:%zu: unknown stage %u.\n", path, line, stage);
+                continue;
+            }
+
+            auto [iter, is_new] = traces.try_emplace(trace_id);
+            if(is_new) iter->second.fill(none);
+            iter->second[stage] = std::min(iter->second[stage], stamp_ns);
+        }
+
+        std::fclose(fp);
+        return true;
+    }
+
+    void print(const char *const name, std::vector<double>& samples) noexcept
+    {
+        if(samples.empty())
+        {
+            std::printf("%-28s %8s\n", name, "-");
+            return;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0;
+        for(const auto sample : samples) sum += sample;
+
+        const auto at = [&samples](const double percentile) noexcept
+        {
+            return samples[std::min(samples.size() - 1, static_cast<std::size_t>(percentile / 100 * samples.size()))];
+        };
+
+        std::printf
+        (
+            "%-28s %8zu %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+            name, samples.size(), sum / samples.size(), at(50), at(90), at(99), samples.back()
+        );
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    if(argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s trace.csv...\n", argv[0]);
+        return 1;
+    }
+
+    std::map<std::uint32_t, Stamps> traces;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!load(argv[i], traces)) return 1;
+    }
+
+    // 隣り合う段階の差と、最初から最後まで。
+    std::vector<double> segments[stage_size];
+    std::size_t incomplete = 0;
+
+    for(const auto& [trace_id, stamps] : traces)
+    {
+        if(std::find(stamps.begin(), stamps.end(), none) != stamps.end())
+        {
+            ++incomplete;
+            continue;
+        }
+
+        for(std::size_t i = 1; i < stage_size; ++i)
+        {
+            segments[i - 1].push_back((static_cast<double>(stamps[i]) - static_cast<double>(stamps[i - 1])) / 1e6);
+        }
+        segments[stage_size - 1].push_back((static_cast<double>(stamps[stage_size - 1]) - static_cast<double>(stamps[0])) / 1e6);
+    }
+
+    std::printf("%zu traces, %zu complete, %zu incomplete\n\n", traces.size(), traces.size() - incomplete, incomplete);
+    std::printf("%-28s %8s %10s %10s %10s %10s %10s [ms]\n", "segment", "count", "mean", "p50", "p90", "p99", "max");
+
+    char name[64];
+    for(std::size_t i = 1; i < stage_size; ++i)
+    {
+        std::snprintf(name, sizeof(name), "%s -> %s", stage_names[i - 1], stage_names[i]);
+        print(name, segments[i - 1]);
+    }
+    std::snprintf(name, sizeof(name), "%s -> %s", stage_names[0], stage_names[stage_size - 1]);
+    print(name, segments[stage_size - 1]);
+}